@@ -0,0 +1,100 @@
+#!/usr/bin/env python3
+"""
+generate.py - Generates a translation unit holding one config, for measuring
+the cost of compiling it (and, with --latency, of its tryget() lookups).
+
+Each config has 50 keys per section, named key0, key1, ... in order, in
+sections section0, section1, ...
+
+Usage: generate.py KEYS POLICY [--latency] > config.cpp
+where POLICY is perfect_hash_index, sorted_index, or linear_index.
+generate.py --baseline > baseline.cpp writes a translation unit that only
+includes the header, whose cost is that of every config's translation unit
+before its config is built.
+"""
+
+import sys
+
+KEYS_PER_SECTION = 50
+POLICIES = ("perfect_hash_index", "sorted_index", "linear_index")
+
+
+def config_text(keys):
+    lines = []
+    for i in range(keys):
+        if i % KEYS_PER_SECTION == 0:
+            lines.append("[section%d]" % (i // KEYS_PER_SECTION))
+        lines.append("key%d = value%d" % (i, i))
+    return "\n".join(lines) + "\n"
+
+
+def baseline_unit():
+    return "\n".join(['#include "ini_config.hpp"', "", "int main() {", "    return 0;", "}", ""])
+
+
+def translation_unit(keys, policy, latency=False):
+    if policy not in POLICIES:
+        raise ValueError("Unknown index policy: " + policy)
+
+    out = ['#include "ini_config.hpp"', ""]
+    if latency:
+        out += ["#include <chrono>", "#include <cstdio>", ""]
+    out += [
+        "constexpr auto config = make_ini_config<R\"INI(",
+        config_text(keys) + ")INI\", ini_config::%s>;" % policy,
+        "",
+    ]
+
+    if not latency:
+        # Only the config itself is measured
+        out += ["int main() {", "    return static_cast<int>(config.size());", "}", ""]
+        return "\n".join(out)
+
+    last = keys - 1
+    out += [
+        "// Read through volatile pointers, so that lookups happen at run-time",
+        'const char *volatile first_key = "key0";',
+        'const char *volatile last_key = "key%d";' % last,
+        'const char *volatile missing_key = "absent";',
+        'const char *volatile last_section = "section%d";' % (last // KEYS_PER_SECTION),
+        "volatile const char *sink;",
+        "",
+        "template<typename Lookup>",
+        "double time_ns(Lookup lookup) {",
+        "    constexpr int iterations = 1 << 20;",
+        "    for (int i = 0; i < 1024; ++i)",
+        "        sink = lookup();",
+        "    auto start = std::chrono::steady_clock::now();",
+        "    for (int i = 0; i < iterations; ++i)",
+        "        sink = lookup();",
+        "    std::chrono::duration<double, std::nano> elapsed = std::chrono::steady_clock::now() - start;",
+        "    return elapsed.count() / iterations;",
+        "}",
+        "",
+        "int main() {",
+        "    // First key, last key, missing key, last key within its section",
+        '    std::printf("%.0f %.0f %.0f %.0f\\n",',
+        "        time_ns([] { return config.tryget(first_key); }),",
+        "        time_ns([] { return config.tryget(last_key); }),",
+        "        time_ns([] { return config.tryget(missing_key); }),",
+        "        time_ns([] { return config.tryget(last_section, last_key); }));",
+        "}",
+        "",
+    ]
+    return "\n".join(out)
+
+
+def main(argv):
+    if "--baseline" in argv:
+        sys.stdout.write(baseline_unit())
+        return 0
+    args = [a for a in argv[1:] if not a.startswith("--")]
+    if len(args) != 2:
+        sys.stderr.write(__doc__)
+        return 2
+    sys.stdout.write(translation_unit(int(args[0]), args[1], "--latency" in argv))
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main(sys.argv))
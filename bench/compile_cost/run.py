@@ -0,0 +1,154 @@
+#!/usr/bin/env python3
+"""
+run.py - Measures compile time, peak compiler memory, and tryget() latency
+against config size, for each index policy and each compiler found.
+
+Generates a config of each size with generate.py, compiles it, and records
+the compiler's wall time and maximum resident set size (the median of three
+builds, for configs that build in under 10 seconds). A translation unit
+that only includes the header is compiled first as a baseline, and each
+config's time is also given less the baseline's, as the cost of the config
+itself. A second build at -O2 times tryget() for the first key, the last
+key, a missing key, and the last key within its section. Prints the results
+as the README's tables.
+
+Usage: run.py [--keys 10,100,1000,10000] [--compilers g++,clang++]
+              [--time-report DIR]
+With --time-report, each compile's -ftime-report output is written to DIR.
+"""
+
+import argparse
+import os
+import shutil
+import subprocess
+import sys
+import tempfile
+import time
+
+import generate
+
+ROOT = os.path.abspath(os.path.join(os.path.dirname(__file__), "..", ".."))
+
+# Raised so that the largest configs build; the tables mark configs that
+# need it (see exceeds_defaults())
+LIMIT_FLAGS = {
+    "gcc": ["-fconstexpr-ops-limit=4294967296"],
+    "clang": ["-fconstexpr-steps=4294967295"],
+}
+
+
+def family(compiler):
+    return "clang" if "clang" in os.path.basename(compiler) else "gcc"
+
+
+def measure(command, report=None):
+    """Runs a command, returning (seconds, peak RSS in MB, stderr)."""
+    start = time.monotonic()
+    proc = subprocess.Popen(command, stdout=subprocess.DEVNULL, stderr=subprocess.PIPE)
+    stderr = proc.stderr.read()
+    _, status, usage = os.wait4(proc.pid, 0)
+    proc.returncode = os.waitstatus_to_exitcode(status)
+    elapsed = time.monotonic() - start
+    if report is not None:
+        with open(report, "wb") as f:
+            f.write(stderr)
+    if proc.returncode != 0:
+        raise RuntimeError("Failed: %s\n%s" % (" ".join(command), stderr.decode(errors="replace")))
+    # ru_maxrss is in KiB on Linux
+    return elapsed, usage.ru_maxrss / 1024, stderr
+
+
+def measure_median(command, report=None):
+    """As measure(), taking the median of three runs unless the first is
+    slow enough that noise does not matter."""
+    first = measure(command, report)
+    if first[0] > 10:
+        return first
+    return sorted([first, measure(command, report), measure(command, report)])[1]
+
+
+def compile_tu(compiler, source, output, optimize, extra=()):
+    command = [compiler, "-std=c++20", "-I", ROOT, optimize, source, "-o", output]
+    return command + LIMIT_FLAGS[family(compiler)] + list(extra)
+
+
+def exceeds_defaults(compiler, source, workdir):
+    """Checks whether a config needs the raised constexpr limits."""
+    command = [compiler, "-std=c++20", "-I", ROOT, "-fsyntax-only", source]
+    return subprocess.run(command, stdout=subprocess.DEVNULL, stderr=subprocess.DEVNULL,
+                          cwd=workdir).returncode != 0
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.split("\n\n")[1])
+    parser.add_argument("--keys", default="10,100,1000,10000")
+    parser.add_argument("--compilers", default="g++,clang++")
+    parser.add_argument("--time-report", metavar="DIR")
+    args = parser.parse_args()
+
+    sizes = [int(k) for k in args.keys.split(",")]
+    compilers = [c for c in args.compilers.split(",") if shutil.which(c)]
+    if not compilers:
+        sys.exit("No compiler found among " + args.compilers)
+    if args.time_report:
+        os.makedirs(args.time_report, exist_ok=True)
+
+    with tempfile.TemporaryDirectory() as workdir:
+        for compiler in compilers:
+            version = subprocess.run([compiler, "--version"], capture_output=True,
+                                     text=True).stdout.splitlines()[0]
+            print("\n%s\n" % version)
+
+            source = os.path.join(workdir, "baseline.cpp")
+            with open(source, "w") as f:
+                f.write(generate.baseline_unit())
+            baseline, baseline_rss, _ = measure_median(compile_tu(compiler, source,
+                os.path.join(workdir, "config"), "-O0"))
+
+            cost = {}
+            latency = {}
+            for keys in sizes:
+                for policy in generate.POLICIES:
+                    source = os.path.join(workdir, "config_%d_%s.cpp" % (keys, policy))
+                    with open(source, "w") as f:
+                        f.write(generate.translation_unit(keys, policy))
+                    extra = []
+                    report = None
+                    if args.time_report:
+                        extra = ["-ftime-report"]
+                        report = os.path.join(args.time_report, "%s_%d_%s.txt" % (
+                            os.path.basename(compiler), keys, policy))
+                    seconds, rss, _ = measure_median(compile_tu(compiler, source,
+                        os.path.join(workdir, "config"), "-O0", extra), report)
+                    cost[keys, policy] = (seconds, rss, exceeds_defaults(compiler, source, workdir))
+
+                    source = os.path.join(workdir, "latency_%d_%s.cpp" % (keys, policy))
+                    with open(source, "w") as f:
+                        f.write(generate.translation_unit(keys, policy, latency=True))
+                    binary = os.path.join(workdir, "latency")
+                    measure(compile_tu(compiler, source, binary, "-O2"))
+                    latency[keys, policy] = subprocess.run([binary], capture_output=True,
+                                                           text=True, check=True).stdout.split()
+
+            print("| Keys   | " + " | ".join("`%s`" % p for p in generate.POLICIES) + " |")
+            print("|--------|" + "|".join("-" * (len(p) + 4) for p in generate.POLICIES) + "|")
+            print("| Header | " + " | ".join(["%.1fs, %d MB" % (baseline, baseline_rss)] * len(generate.POLICIES)) + " |")
+            for keys in sizes:
+                cells = []
+                for policy in generate.POLICIES:
+                    seconds, rss, limited = cost[keys, policy]
+                    cells.append("%.1fs (+%.1fs), %d MB%s" % (seconds, max(seconds - baseline, 0.0), rss,
+                                                           " ¹" if limited else ""))
+                print("| %-6d | %s |" % (keys, " | ".join(cells)))
+            print("\n¹ Exceeds the compiler's default constexpr limits.\n")
+
+            print("| Index | Keys | First | Last | Miss | Section |")
+            print("|-------|------|-------|------|------|---------|")
+            for policy in generate.POLICIES:
+                for keys in sizes:
+                    print("| `%s` | %d | %s |" % (policy, keys, " | ".join(latency[keys, policy])))
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
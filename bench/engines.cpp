@@ -0,0 +1,615 @@
+/**
+ * engines.cpp - Differential fuzzing and benchmarking of ini_config's engines.
+ *
+ * Generates random INI texts of several shapes and parses each with every
+ * engine: ini_config (at compile-time), runtime_config, mapped_config,
+ * blob_config, layered_config, and the stream parser. Every engine must give
+ * the same sequence of kvps and the same tryget() results as the generator's
+ * own record of the text; as ini_config is held to that record too, the
+ * engines agree with ini_config. Their parse throughput and lookup latency
+ * are then reported in one table.
+ *
+ * Build with e.g.:
+ *   g++ -std=c++20 -O2 -march=native -I.. engines.cpp -o engines
+ * and add -DTCSULLIVAN_INI_CONFIG_NO_SIMD or -DTCSULLIVAN_INI_CONFIG_NO_THREADS
+ * to compare against the scalar or single-threaded parse.
+ *
+ * Usage: engines [size_kib [rounds [seed]]]
+ * The first round parses texts of size_kib (default 4096) and is timed; the
+ * other rounds (default 16) only check agreement, on smaller texts of random
+ * size. Returns 1 if any engine disagrees.
+ */
+
+#include "ini_config_runtime.hpp"
+
+#include <algorithm> // std::copy, std::max, std::min
+#include <chrono> // std::chrono::duration, std::chrono::steady_clock
+#include <cstdint> // std::uint64_t
+#include <cstdio> // std::fprintf, std::printf
+#include <cstdlib> // std::strtoull
+#include <deque> // std::deque
+#include <filesystem> // std::filesystem::remove, std::filesystem::temp_directory_path
+#include <fstream> // std::ofstream
+#include <span> // std::span
+#include <string> // std::string, std::to_string
+#include <string_view> // std::string_view
+#include <unordered_map> // std::unordered_map
+#include <unordered_set> // std::unordered_set
+#include <vector> // std::vector
+
+namespace {
+
+using clock_type = std::chrono::steady_clock;
+
+// Random numbers that can also be drawn at compile-time (splitmix64)
+struct rng {
+    std::uint64_t state;
+
+    constexpr std::uint64_t next() noexcept {
+        auto z = (state += 0x9E3779B97F4A7C15ull);
+        z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+        z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+        return z ^ (z >> 31);
+    }
+    constexpr unsigned int below(unsigned int n) noexcept {
+        return static_cast<unsigned int>(next() % n);
+    }
+};
+
+/**
+ * The shapes of text that are generated, each stressing a different part of
+ * parsing or lookup.
+ */
+enum class shape {
+    deep_sections,  // Many small sections with long, dotted names
+    long_values,    // Few keys with long values holding '=', '[', ';', and '#'
+    comment_heavy,  // Several comment and blank lines for every kvp
+    duplicate_keys, // A small vocabulary of keys, repeated within and across sections
+    many_sections   // A section header for every kvp, some reopening earlier sections
+};
+constexpr shape all_shapes[] = {
+    shape::deep_sections, shape::long_values, shape::comment_heavy, shape::duplicate_keys,
+    shape::many_sections
+};
+
+constexpr const char *shape_name(shape s) noexcept {
+    switch (s) {
+    case shape::deep_sections:  return "deep_sections";
+    case shape::long_values:    return "long_values";
+    case shape::comment_heavy:  return "comment_heavy";
+    case shape::duplicate_keys: return "duplicate_keys";
+    case shape::many_sections:  return "many_sections";
+    }
+    return "";
+}
+
+constexpr char alnum[] = "abcdefghijklmnopqrstuvwxyzABCDEFGHIJKLMNOPQRSTUVWXYZ0123456789";
+// Chars allowed within values, including ones that delimit other lines
+constexpr char value_chars[] = "abcdefghijklmnopqrstuvwxyz0123456789 =[];#_-.:/,\t";
+
+constexpr void append_number(std::string& out, unsigned int n) {
+    char digits[10] = {};
+    int count = 0;
+    do {
+        digits[count++] = static_cast<char>('0' + n % 10);
+        n /= 10;
+    } while (n != 0);
+    while (count != 0)
+        out += digits[--count];
+}
+
+constexpr void append_padding(std::string& out, rng& r, unsigned int most) {
+    for (auto n = r.below(most + 1); n != 0; --n)
+        out += r.below(4) == 0 ? '\t' : ' ';
+}
+
+/**
+ * Generates INI text of the given shape until it holds at least 'bytes'
+ * chars. Lines are passed to sink.text(), and each kvp, as it should be
+ * parsed, to sink.kvp(section, key, value). Usable at compile-time.
+ */
+template<typename Sink>
+constexpr void generate(shape s, std::uint64_t seed, std::size_t bytes, Sink& sink) {
+    rng r{seed};
+    std::string section;
+    std::string line;
+    std::size_t length = 0;
+    unsigned int sections = 0;
+    unsigned int kvps = 0;
+    const unsigned int per_section = s == shape::many_sections ? 1 : s == shape::deep_sections ? 3
+        : s == shape::long_values ? 4 : 12;
+
+    const auto emit = [&] {
+        line += '\n';
+        length += line.size();
+        sink.text(std::string_view(line));
+        line.clear();
+    };
+
+    // Keys above the first section header
+    for (auto top = r.below(4); length < bytes; ++kvps) {
+        if (kvps >= top && (kvps == top || r.below(per_section) == 0)) {
+            section.clear();
+            if (s == shape::deep_sections) {
+                for (auto depth = 2 + r.below(7); depth != 0; --depth) {
+                    for (auto n = 1 + r.below(6); n != 0; --n)
+                        section += alnum[r.below(26)];
+                    section += '.';
+                }
+            } else if (s != shape::many_sections && r.below(4) == 0) {
+                section += "sec tion ";
+            }
+            section += 's';
+            if (s == shape::many_sections && sections != 0 && r.below(8) == 0)
+                append_number(section, r.below(sections));
+            else
+                append_number(section, sections++);
+
+            if (r.below(3) == 0)
+                emit();
+            append_padding(line, r, 2);
+            line += '[';
+            line += section;
+            line += ']';
+            emit();
+        }
+
+        const auto comments = s == shape::comment_heavy ? 1 + r.below(6) : r.below(16) == 0 ? 1 : 0;
+        for (unsigned int i = 0; i < comments; ++i) {
+            if (r.below(3) == 0) {
+                append_padding(line, r, 3);
+            } else {
+                append_padding(line, r, 2);
+                line += r.below(2) == 0 ? ';' : '#';
+                line += r.below(2) == 0 ? " [not_a_section] key = value" : "=";
+                for (auto n = r.below(40); n != 0; --n)
+                    line += value_chars[r.below(sizeof(value_chars) - 1)];
+            }
+            emit();
+        }
+
+        std::string key;
+        if (s == shape::duplicate_keys) {
+            key += 'k';
+            append_number(key, r.below(6));
+        } else {
+            key += alnum[r.below(26)];
+            for (auto n = r.below(12); n != 0; --n)
+                key += r.below(8) == 0 ? "_.-"[r.below(3)] : alnum[r.below(sizeof(alnum) - 1)];
+            key += '_';
+            append_number(key, kvps);
+        }
+
+        // A value begins and ends with a graphic char, as outer whitespace is not kept
+        std::string value;
+        value += alnum[r.below(sizeof(alnum) - 1)];
+        const auto value_length = s == shape::long_values ? 64 + r.below(960) : r.below(24);
+        for (auto n = value_length; n != 0; --n)
+            value += value_chars[r.below(sizeof(value_chars) - 1)];
+        if (value_length != 0)
+            value += alnum[r.below(sizeof(alnum) - 1)];
+
+        append_padding(line, r, 2);
+        line += key;
+        append_padding(line, r, 2);
+        line += '=';
+        append_padding(line, r, 2);
+        line += value;
+        sink.kvp(std::string_view(section), std::string_view(key), std::string_view(value));
+        emit();
+    }
+}
+
+struct text_sink {
+    std::string out;
+
+    constexpr void text(std::string_view line) {
+        out += line;
+    }
+    constexpr void kvp(std::string_view, std::string_view, std::string_view) {}
+};
+
+constexpr std::string generate_text(shape s, std::uint64_t seed, std::size_t bytes) {
+    text_sink sink;
+    generate(s, seed, bytes, sink);
+    return sink.out;
+}
+
+// Compile-time texts are kept small enough for gcc's default constexpr limits
+constexpr std::size_t static_bytes = 3000;
+constexpr std::uint64_t static_seed = 0x5EED;
+
+/**
+ * Generates a shape's text at compile-time, as a template argument for
+ * ini_config.
+ */
+template<shape S>
+consteval auto static_corpus() {
+    constexpr auto size = generate_text(S, static_seed, static_bytes).size() + 1;
+    auto text = generate_text(S, static_seed, static_bytes);
+    char data[size] = {};
+    std::copy(text.begin(), text.end(), data);
+    return ini_config::string_container<char, size>(data);
+}
+
+// A kvp as the generator recorded it
+struct record {
+    std::string section;
+    std::string key;
+    std::string value;
+};
+
+// A lookup, made with or without a section, and the value it should find
+struct query {
+    bool has_section;
+    std::string section;
+    std::string key;
+    std::string_view expected; // Empty for a missing key
+};
+
+/**
+ * What every engine should produce for a text: its kvps in order, and the
+ * results of a random sample of lookups.
+ */
+struct reference {
+    std::string text;
+    std::vector<record> records;
+    std::vector<query> queries;
+
+    reference(shape s, std::uint64_t seed, std::size_t bytes) {
+        struct sink {
+            reference& ref;
+            void text(std::string_view line) {
+                ref.text += line;
+            }
+            void kvp(std::string_view section, std::string_view key, std::string_view value) {
+                ref.records.push_back({ std::string(section), std::string(key), std::string(value) });
+            }
+        } out{*this};
+        generate(s, seed, bytes, out);
+
+        // The first of equal keys is found, in a section or in the whole
+        // config. Only a section's first run of kvps is searched, so the
+        // kvps of a reopened section are only found anywhere.
+        std::unordered_map<std::string, std::string_view> in_section;
+        std::unordered_map<std::string, std::string_view> anywhere;
+        std::unordered_set<std::string> closed;
+        for (std::size_t i = 0; i < records.size(); ++i) {
+            const auto& rec = records[i];
+            if (i != 0 && records[i - 1].section != rec.section)
+                closed.insert(records[i - 1].section);
+            if (!closed.contains(rec.section))
+                in_section.emplace(rec.section + '\0' + rec.key, rec.value);
+            anywhere.emplace(rec.key, rec.value);
+        }
+        const auto find = [](const auto& map, const std::string& name) {
+            auto it = map.find(name);
+            return it != map.end() ? it->second : std::string_view();
+        };
+
+        rng r{seed ^ 0x9E7};
+        const auto count = std::min<std::size_t>(4096, records.size() * 4);
+        for (std::size_t i = 0; i < count && !records.empty(); ++i) {
+            const auto& rec = records[r.below(static_cast<unsigned int>(records.size()))];
+            const auto& other = records[r.below(static_cast<unsigned int>(records.size()))];
+            query q{ false, {}, rec.key, {} };
+            switch (r.below(5)) {
+            case 0: // A key in its section
+                q.has_section = !rec.section.empty();
+                q.section = rec.section;
+                break;
+            case 1: // A key in whichever section has it first
+                break;
+            case 2: // A key in some other section, where it may be missing
+                q.has_section = !other.section.empty();
+                q.section = other.section;
+                break;
+            case 3: // A missing key in a section
+                q.has_section = !rec.section.empty();
+                q.section = rec.section;
+                q.key += "_absent";
+                break;
+            default: // A missing key
+                q.key = "absent_" + rec.key;
+                break;
+            }
+            q.expected = q.has_section ? find(in_section, q.section + '\0' + q.key) : find(anywhere, q.key);
+            queries.push_back(std::move(q));
+        }
+    }
+};
+
+// Gives a common form to the strings of each engine's kvps and values
+std::string_view as_view(const char *s) noexcept {
+    return s != nullptr ? std::string_view(s) : std::string_view();
+}
+std::string_view as_view(std::string_view s) noexcept {
+    return s;
+}
+
+// One line of the report
+struct result {
+    std::string corpus;
+    std::string engine;
+    std::string checks;
+    std::string mismatch; // Empty if the engine agreed
+    double parse_mbps = -1;
+    double lookup_ns = -1;
+};
+
+std::string describe(std::string_view section, std::string_view key, std::string_view value) {
+    return "[" + std::string(section) + "]" + std::string(key) + "=" + std::string(value);
+}
+
+// Checks an engine's kvps against the reference, in order
+template<typename Range>
+void check_sequence(const Range& kvps, const reference& ref, result& res) {
+    res.checks += res.checks.empty() ? "seq" : ",seq";
+    std::size_t i = 0;
+    for (auto kvp : kvps) {
+        if (i == ref.records.size()) {
+            res.mismatch = "kvp " + std::to_string(i) + " is extra: " +
+                describe(as_view(kvp.section), as_view(kvp.first), as_view(kvp.second));
+            return;
+        }
+        const auto& rec = ref.records[i];
+        if (as_view(kvp.section) != rec.section || as_view(kvp.first) != rec.key ||
+            as_view(kvp.second) != rec.value)
+        {
+            res.mismatch = "kvp " + std::to_string(i) + " is " +
+                describe(as_view(kvp.section), as_view(kvp.first), as_view(kvp.second)) +
+                ", expected " + describe(rec.section, rec.key, rec.value);
+            return;
+        }
+        ++i;
+    }
+    if (i != ref.records.size())
+        res.mismatch = "only " + std::to_string(i) + " of " + std::to_string(ref.records.size()) + " kvps";
+}
+
+template<typename Config>
+std::string_view lookup(const Config& config, const query& q) {
+    if (q.has_section)
+        return as_view(config.tryget(std::string_view(q.section), std::string_view(q.key)));
+    return as_view(config.tryget(std::string_view(q.key)));
+}
+
+volatile std::size_t lookup_sink;
+
+// Checks an engine's lookups against the reference, then times them
+template<typename Config>
+void check_lookups(const Config& config, const reference& ref, result& res, bool timed) {
+    res.checks += res.checks.empty() ? "get" : ",get";
+    if (!res.mismatch.empty())
+        return;
+    for (const auto& q : ref.queries) {
+        if (auto value = lookup(config, q); value != q.expected) {
+            res.mismatch = "tryget(" + (q.has_section ? q.section + ", " : std::string()) + q.key +
+                ") is \"" + std::string(value) + "\", expected \"" + std::string(q.expected) + "\"";
+            return;
+        }
+    }
+    if (!timed || ref.queries.empty())
+        return;
+
+    // Cycles through the queries for at least 20 ms
+    std::size_t count = 0;
+    std::size_t found = 0;
+    const auto start = clock_type::now();
+    auto elapsed = clock_type::duration();
+    do {
+        for (auto n = 64; n != 0; --n, ++count)
+            found += lookup(config, ref.queries[count % ref.queries.size()]).size();
+        elapsed = clock_type::now() - start;
+    } while (elapsed < std::chrono::milliseconds(20));
+    res.lookup_ns = std::chrono::duration<double, std::nano>(elapsed).count() / static_cast<double>(count);
+    lookup_sink = found; // Keeps the lookups from being optimized out
+}
+
+/**
+ * Parses with 'make' (best of a few runs, if timed) and checks the result,
+ * catching what it throws as a mismatch.
+ */
+template<typename Make, typename Check>
+result run(const char *corpus, const char *engine, const reference& ref, bool timed, Make make, Check check) {
+    result res{ corpus, engine, {}, {} };
+    try {
+        auto best = clock_type::duration::max();
+        auto config = [&] {
+            auto start = clock_type::now();
+            auto c = make();
+            best = std::min(best, clock_type::now() - start);
+            return c;
+        }();
+        for (int i = 1; timed && i < 3; ++i) {
+            auto start = clock_type::now();
+            auto again = make();
+            best = std::min(best, clock_type::now() - start);
+        }
+        if (timed) {
+            res.parse_mbps = static_cast<double>(ref.text.size()) / 1e6 /
+                std::chrono::duration<double>(best).count();
+        }
+        check(config, res);
+    } catch (const std::exception& e) {
+        res.mismatch = std::string("threw: ") + e.what();
+    }
+    return res;
+}
+
+/**
+ * Runs the run-time engines over the reference's text.
+ */
+void run_engines(const char *corpus, const reference& ref, bool timed, std::vector<result>& results) {
+    const std::string_view text(ref.text);
+    const auto both = [&](const auto& config, result& res) {
+        check_sequence(config, ref, res);
+        check_lookups(config, ref, res, timed);
+    };
+
+    results.push_back(run(corpus, "runtime_config", ref, timed,
+        [&] { return ini_config::runtime_config(text); }, both));
+    results.push_back(run(corpus, "runtime_config<sorted>", ref, timed,
+        [&] { return ini_config::basic_runtime_config<char, ini_config::sorted_index>(text); }, both));
+    results.push_back(run(corpus, "runtime_config<linear>", ref, timed,
+        [&] { return ini_config::basic_runtime_config<char, ini_config::linear_index>(text); }, both));
+
+#ifdef TCSULLIVAN_INI_CONFIG_HAS_MMAP
+    const auto path = std::filesystem::temp_directory_path() / ("ini_config_engines_" + std::string(corpus) + ".ini");
+    std::ofstream(path, std::ios::binary).write(text.data(), static_cast<std::streamsize>(text.size()));
+    results.push_back(run(corpus, "mapped_config", ref, timed,
+        [&] { return ini_config::mapped_config::from_file(path.c_str()); }, both));
+    std::filesystem::remove(path);
+#endif
+
+    // These are made from a parsed config, so only loading the blob or
+    // merging the layer is timed
+    try {
+        const ini_config::runtime_config parsed(text);
+        const auto blob = parsed.blob();
+        results.push_back(run(corpus, "blob_config", ref, timed,
+            [&] { return ini_config::blob_config(std::span<const unsigned char>(blob.data(), blob.size())); },
+            both));
+        results.back().parse_mbps = -1; // Loaded in place, without parsing
+
+        const ini_config::runtime_config base;
+        results.push_back(run(corpus, "layered_config", ref, timed,
+            [&] { return ini_config::layered_config(base, parsed); },
+            [&](const auto& config, result& res) { check_lookups(config, ref, res, timed); }));
+    } catch (const std::exception& e) {
+        results.push_back({ corpus, "blob_config, layered_config", {}, std::string("threw: ") + e.what() });
+    }
+
+    results.push_back(run(corpus, "stream_parser", ref, timed,
+        [&] {
+            std::vector<ini_config::runtime_config::kvp> kvps;
+            std::deque<std::string> strings; // Holds the kvps' strings in place
+            auto parser = ini_config::make_stream_parser(
+                [](std::string_view) {},
+                [&](std::string_view section, std::string_view key, std::string_view value) {
+                    strings.emplace_back(section);
+                    auto s = strings.back().c_str();
+                    strings.emplace_back(key);
+                    auto k = strings.back().c_str();
+                    strings.emplace_back(value);
+                    kvps.push_back({ s, k, strings.back().c_str() });
+                });
+            for (std::size_t at = 0; at < text.size(); at += 65536)
+                parser.feed(text.substr(at, 65536));
+            parser.finish();
+            return std::pair(std::move(kvps), std::move(strings));
+        },
+        [&](const auto& parsed, result& res) { check_sequence(parsed.first, ref, res); }));
+}
+
+/**
+ * Runs ini_config, with each index policy and through a compile-time blob,
+ * and the run-time engines over a shape's compile-time text.
+ */
+template<shape S>
+void run_static(std::vector<result>& results) {
+    constexpr auto corpus = static_corpus<S>();
+    const reference ref(S, static_seed, static_bytes);
+    const auto name = shape_name(S);
+    if (ref.text != std::string_view(corpus.data, corpus.size() - 1)) {
+        results.push_back({ name, "ini_config", {}, "compile-time text differs from run-time text" });
+        return;
+    }
+
+    const auto add = [&](const char *engine, const auto& config) {
+        result res{ name, engine, {}, {} };
+        check_sequence(config, ref, res);
+        check_lookups(config, ref, res, true);
+        results.push_back(std::move(res));
+    };
+    add("ini_config", make_ini_config<corpus>);
+    add("ini_config<sorted>", make_ini_config<corpus, ini_config::sorted_index>);
+    add("ini_config<linear>", make_ini_config<corpus, ini_config::linear_index>);
+
+    alignas(8) constexpr static auto blob = make_ini_config<corpus>.blob();
+    results.push_back(run(name, "blob_config (compile-time)", ref, true,
+        [&] { return ini_config::blob_config(std::span<const unsigned char>(blob.data(), blob.size())); },
+        [&](const auto& config, result& res) {
+            check_sequence(config, ref, res);
+            check_lookups(config, ref, res, true);
+        }));
+    results.back().parse_mbps = -1;
+
+    // An empty layer over the compile-time config, whose answers must all
+    // come from the base
+    const ini_config::runtime_config layer;
+    results.push_back(run(name, "layered_config (base)", ref, true,
+        [&] { return ini_config::layered_config(make_ini_config<corpus>, layer); },
+        [&](const auto& config, result& res) { check_lookups(config, ref, res, true); }));
+
+    run_engines(name, ref, true, results);
+}
+
+void print_table(const char *title, std::size_t bytes, const std::vector<result>& results) {
+    std::printf("\n%s (%zu KiB per corpus)\n", title, bytes / 1024);
+    std::printf("%-15s %-27s %-8s %-6s %11s %10s\n", "corpus", "engine", "checks", "agree", "parse MB/s", "ns/lookup");
+    for (const auto& res : results) {
+        std::printf("%-15s %-27s %-8s %-6s ", res.corpus.c_str(), res.engine.c_str(), res.checks.c_str(),
+            res.mismatch.empty() ? "yes" : "NO");
+        if (res.parse_mbps >= 0)
+            std::printf("%11.1f ", res.parse_mbps);
+        else
+            std::printf("%11s ", "-");
+        if (res.lookup_ns >= 0)
+            std::printf("%10.1f\n", res.lookup_ns);
+        else
+            std::printf("%10s\n", "-");
+    }
+}
+
+// Reports disagreements, returning true if there were any
+bool report(const std::vector<result>& results, std::uint64_t seed) {
+    bool failed = false;
+    for (const auto& res : results) {
+        if (!res.mismatch.empty()) {
+            std::fprintf(stderr, "%s disagrees on %s (seed %llu): %s\n", res.engine.c_str(),
+                res.corpus.c_str(), static_cast<unsigned long long>(seed), res.mismatch.c_str());
+            failed = true;
+        }
+    }
+    return failed;
+}
+
+} // namespace
+
+int main(int argc, char **argv) {
+    const std::size_t bytes = (argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 4096) * 1024;
+    const auto rounds = argc > 2 ? std::strtoull(argv[2], nullptr, 10) : 16;
+    const std::uint64_t seed = argc > 3 ? std::strtoull(argv[3], nullptr, 10) : 1;
+    bool failed = false;
+
+    std::vector<result> results;
+    run_static<shape::deep_sections>(results);
+    run_static<shape::long_values>(results);
+    run_static<shape::comment_heavy>(results);
+    run_static<shape::duplicate_keys>(results);
+    run_static<shape::many_sections>(results);
+    failed |= report(results, static_seed);
+    print_table("Compile-time texts", static_bytes, results);
+
+    results.clear();
+    for (auto s : all_shapes) {
+        const reference ref(s, seed, bytes);
+        run_engines(shape_name(s), ref, true, results);
+    }
+    failed |= report(results, seed);
+    print_table("Run-time texts", bytes, results);
+
+    rng r{seed};
+    for (std::uint64_t round = 1; round < rounds; ++round) {
+        results.clear();
+        for (auto s : all_shapes) {
+            const reference ref(s, seed + round, 1 + r.below(64 * 1024));
+            run_engines(shape_name(s), ref, false, results);
+        }
+        failed |= report(results, seed + round);
+    }
+    std::printf("\n%llu rounds: %s\n", static_cast<unsigned long long>(rounds),
+        failed ? "engines disagree" : "all engines agree");
+    return failed ? 1 : 0;
+}
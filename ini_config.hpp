@@ -7,319 +7,3257 @@
 #ifndef TCSULLIVAN_INI_CONFIG_HPP
 #define TCSULLIVAN_INI_CONFIG_HPP
 
-// Uncomment below to run std::forward_iterator check
-//#define TCSULLIVAN_INI_CONFIG_CHECK_FORWARD_ITERATOR
+// Uncomment below to run std::random_access_iterator check
+//#define TCSULLIVAN_INI_CONFIG_CHECK_RANDOM_ACCESS_ITERATOR
 
-#ifdef TCSULLIVAN_INI_CONFIG_CHECK_FORWARD_ITERATOR
-#include <iterator> // std::forward_iterator
+// Uncomment below to disable vectorized scanning of run-time text
+//#define TCSULLIVAN_INI_CONFIG_NO_SIMD
+
+#include <algorithm> // std::clamp, std::find, std::lower_bound, std::partition_point, std::sort,
+                     // std::stable_sort, std::unique
+#include <array> // std::array
+#include <atomic> // std::atomic, std::memory_order
+#include <bit> // std::bit_ceil, std::bit_width, std::countr_zero, std::endian
+#include <charconv> // std::from_chars
+#include <chrono> // std::chrono::duration_cast, std::chrono::nanoseconds, std::chrono::steady_clock
+#include <concepts> // std::integral, std::floating_point, std::same_as
+#include <compare> // std::strong_ordering
+#include <cstddef> // std::nullptr_t, std::ptrdiff_t, std::size_t
+#include <cstdint> // std::uint16_t, std::uint32_t, std::uint64_t
+#include <cstring> // std::memcmp, std::memcpy
+#include <iterator> // std::input_iterator_tag, std::random_access_iterator_tag, std::size
+#include <limits> // std::numeric_limits
+#include <memory> // std::make_unique, std::unique_ptr
+#include <span> // std::span
+#include <stdexcept> // std::length_error
+#include <string> // std::basic_string, std::string, std::to_string
+#include <string_view> // std::basic_string_view
+#include <system_error> // std::errc
+#include <tuple> // std::get, std::tuple_size_v
+#include <type_traits> // std::conditional_t, std::is_constant_evaluated, std::is_void_v,
+                       // std::is_signed_v, std::is_unsigned_v, std::make_unsigned_t
+#include <utility> // std::index_sequence, std::make_index_sequence, std::pair
+#include <vector> // std::vector
+
+#ifndef TCSULLIVAN_INI_CONFIG_NO_SIMD
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define TCSULLIVAN_INI_CONFIG_SSE2
+#if defined(__AVX2__)
+#include <immintrin.h> // _mm256_cmpeq_epi8, _mm256_movemask_epi8
+#else
+#include <emmintrin.h> // _mm_cmpeq_epi8, _mm_cmpeq_epi16, _mm_cmpeq_epi32, _mm_movemask_epi8
+#endif
+#elif defined(__ARM_NEON)
+#define TCSULLIVAN_INI_CONFIG_NEON
+#include <arm_neon.h> // vceqq_u8, vceqq_u16, vceqq_u32, vmovn_u16, vmovn_u32, vshrn_n_u16
+#endif
+#endif // TCSULLIVAN_INI_CONFIG_NO_SIMD
+
+namespace ini_config {
+
+/**
+ * A minimal container for a given string literal, used to allow string
+ * literals to be passed as template parameters.
+ */
+template<typename T = char, unsigned long int N = 0>
+struct string_container {
+    using char_type = T;
+
+    char_type data[N];
+    consteval string_container(const char_type (&s)[N]) noexcept {
+        auto dst = data;
+        for (auto src = s; src != s + N; ++src)
+            *dst++ = *src;
+    }
+    consteval operator const char_type *() const noexcept {
+        return data;
+    }
+    consteval auto size() const noexcept {
+        return N;
+    }
+    consteval auto begin() const noexcept {
+        return data;
+    }
+    consteval auto end() const noexcept {
+        return data + N;
+    }
+};
+
+/**
+ * Lookup index policies, selecting how tryget() and trycontains() find keys.
+ * Pass one as an option to ini_config (e.g. make_ini_config<..., sorted_index>).
+ */
+// Constant-time lookups through a perfect hash (the default). Configs whose
+// keys admit none fall back to a sorted index.
+struct perfect_hash_index {};
+// Logarithmic-time lookups through a sorted table, using less memory.
+struct sorted_index {};
+// Linear-time lookups by iterating the config, using no extra memory.
+struct linear_index {};
+
+/**
+ * Option to convert every value at compile-time, so that typed tryget()
+ * calls return a stored result instead of parsing the value each time.
+ */
+struct value_cache {};
+
+/**
+ * Option to keep only the named sections of the text, so that a program
+ * embeds just the sections it uses (e.g. sections<"Net", "Log">). Keys
+ * above the first section header are kept if "" is named.
+ */
+template<string_container... Names>
+struct sections {
+    // Checks if [first, last) is one of Names
+    template<typename char_type>
+    constexpr static bool contains(const char_type *first, const char_type *last) noexcept {
+        return ((std::basic_string_view<char_type>(first, last) ==
+            std::basic_string_view<char_type>(Names.data, std::size(Names.data) - 1)) || ...);
+    }
+};
+
+/**
+ * Option to drop the text of values that are numbers, for keys that are only
+ * read through typed handle()s: string lookups of such keys give "", though
+ * contains() and trycontains() still find them. Compile-time conversions
+ * still read the text; add value_cache for tryget<T>() to convert them.
+ */
+struct drop_number_text {};
+
+/**
+ * Option for configs of wider chars (e.g. L"..."_ini) to store their text as
+ * UTF-8, taking a half or a quarter of the space. The config's interface
+ * then takes and returns UTF-8 strings; run-time lookups may also be given
+ * strings of the original char type, which are transcoded on demand.
+ */
+struct utf8_storage {};
+
+/**
+ * Option to count run-time lookups: hits per key, misses per query, and a
+ * histogram of lookup latencies, as well as the time spent in each phase of
+ * a run-time parse. stats_json() reports them. Without this option, lookups
+ * and parsing are not instrumented at all.
+ */
+struct lookup_stats {};
+
+/**
+ * Option to lay out a config for its hottest keys, as listed (hottest first)
+ * by the "profile" of stats_json(): e.g. profile<"[Net]port", "debug">. A
+ * key in brackets is the one found in that section, and a bare key is the
+ * one found by tryget(key). Their keys and values are packed at the front of
+ * the buffer, and sorted and linear lookups check them before searching.
+ * Keys that are not in the config are ignored.
+ */
+template<string_container... Keys>
+struct profile {
+    constexpr static std::size_t size = sizeof...(Keys);
+
+    // Calls fn(key) with each of Keys, as a string view
+    template<typename char_type, typename Fn>
+    constexpr static void for_each(Fn&& fn) {
+        static_assert((std::same_as<typename decltype(Keys)::char_type, char_type> && ...),
+            "Profile keys must have the config's char type!");
+        (fn(std::basic_string_view<char_type>(Keys.data, std::size(Keys.data) - 1)), ...);
+    }
+};
+
+/**
+ * Reasons that tryconvert() can fail.
+ */
+enum class conversion_error {
+    missing_key,   // The key does not exist
+    invalid_value, // The value is not entirely a number of the requested type
+    out_of_range   // The number does not fit in the requested type
+};
+
+/**
+ * The result of tryconvert(): either the converted value or the reason it
+ * could not be converted, in the manner of C++23's std::expected.
+ */
+template<typename T>
+class conversion_result {
+    T m_value = T();
+    conversion_error m_error = conversion_error::missing_key;
+    bool m_has_value = false;
+
+public:
+    constexpr conversion_result(T value) noexcept
+        : m_value(value), m_has_value(true) {}
+    constexpr conversion_result(conversion_error error) noexcept
+        : m_error(error) {}
+
+    constexpr bool has_value() const noexcept {
+        return m_has_value;
+    }
+    constexpr explicit operator bool() const noexcept {
+        return m_has_value;
+    }
+    // Returns the converted value, which must exist
+    constexpr T operator*() const noexcept {
+        return m_value;
+    }
+    constexpr T value_or(T other) const noexcept {
+        return m_has_value ? m_value : other;
+    }
+    // Returns the reason for failure, which must exist
+    constexpr conversion_error error() const noexcept {
+        return m_error;
+    }
+};
+
+template<typename CharT>
+class basic_key;
+
+// Implementation shared by ini_config and basic_runtime_config.
+namespace detail {
+
+template<typename T>
+struct is_index_policy : std::bool_constant<std::same_as<T, perfect_hash_index> ||
+    std::same_as<T, sorted_index> || std::same_as<T, linear_index>> {};
+
+template<typename T>
+struct is_section_filter : std::false_type {};
+template<string_container... Names>
+struct is_section_filter<sections<Names...>> : std::true_type {};
+
+template<typename T>
+struct is_profile : std::false_type {};
+template<string_container... Keys>
+struct is_profile<profile<Keys...>> : std::true_type {};
+
+// Picks the first of Options that satisfies Trait, or Default if none do.
+template<template<typename> class Trait, typename Default, typename... Options>
+struct find_option {
+    using type = Default;
+};
+template<template<typename> class Trait, typename Default, typename T, typename... Options>
+struct find_option<Trait, Default, T, Options...> {
+    using type = std::conditional_t<Trait<T>::value, T,
+        typename find_option<Trait, Default, Options...>::type>;
+};
+
+// Bytes of UTF-8 sequences count as graphic, even where char is signed
+template<typename char_type>
+constexpr bool isgraph(char_type c) noexcept {
+    auto u = static_cast<std::make_unsigned_t<char_type>>(c);
+    return u > ' ' && u != 0x7F;
+}
+template<typename char_type>
+constexpr bool iseol(char_type c) noexcept {
+    return c == '\n' || c == '\0';
+}
+template<typename char_type>
+constexpr bool iscomment(char_type c) noexcept {
+    return c == ';' || c == '#';
+}
+
+template<typename char_type>
+constexpr bool stringmatch(const char_type *a, const char_type *b) noexcept {
+    while (*a == *b && (*a != '\0' || *b != '\0'))
+        ++a, ++b;
+    return *a == *b && *a == '\0';
+}
+// Compares a null-terminated string with a view, without measuring it
+template<typename char_type>
+constexpr bool stringmatch(const char_type *a, std::basic_string_view<char_type> b) noexcept {
+    for (auto c : b) {
+        if (*a == '\0' || *a != c)
+            return false;
+        ++a;
+    }
+    return *a == '\0';
+}
+template<typename char_type>
+constexpr std::strong_ordering stringcompare(const char_type *a, const char_type *b) noexcept {
+    while (*a == *b && *a != '\0')
+        ++a, ++b;
+    return *a <=> *b;
+}
+// Marks the end of a null-terminated string, so that string helpers can be
+// given either a terminator or an end pointer (e.g. for memory-mapped text)
+struct null_sentinel {};
+template<typename char_type>
+constexpr bool operator==(const char_type *str, null_sentinel) noexcept {
+    return *str == '\0';
+}
+
+// An empty string of each char type, returned for missing keys
+template<typename char_type>
+inline constexpr char_type empty_string[1] = {};
+
+// Compares two strings for equality. Wider chars are compared as bytes, as
+// char_traits may compare them one at a time.
+template<typename char_type>
+constexpr bool equal_views(std::basic_string_view<char_type> a, std::basic_string_view<char_type> b) noexcept {
+    if (a.size() != b.size())
+        return false;
+    if constexpr (sizeof(char_type) > 1) {
+        if (!std::is_constant_evaluated())
+            return std::memcmp(a.data(), b.data(), a.size() * sizeof(char_type)) == 0;
+    }
+    return a == b;
+}
+
+// Decodes one code point from UTF-8 (for 1-byte chars), UTF-16 (2-byte
+// chars), or UTF-32 (4-byte chars). Invalid sequences give U+FFFD.
+template<typename char_type>
+constexpr char32_t decode(const char_type *&p, const char_type *end) noexcept {
+    if constexpr (sizeof(char_type) == 1) {
+        auto c = static_cast<unsigned char>(*p++);
+        if (c < 0x80)
+            return c;
+        int extra = c >= 0xF0 ? 3 : c >= 0xE0 ? 2 : c >= 0xC0 ? 1 : 0;
+        if (extra == 0 || c >= 0xF8)
+            return 0xFFFD;
+        char32_t cp = c & (0x3F >> extra);
+        for (int i = 0; i < extra; ++i) {
+            if (p == end || (static_cast<unsigned char>(*p) & 0xC0) != 0x80)
+                return 0xFFFD;
+            cp = (cp << 6) | (static_cast<unsigned char>(*p++) & 0x3F);
+        }
+        // Reject overlong forms, surrogates, and code points past U+10FFFF
+        constexpr char32_t least[4] = { 0, 0x80, 0x800, 0x10000 };
+        if (cp < least[extra] || cp > 0x10FFFF || (cp >= 0xD800 && cp < 0xE000))
+            return 0xFFFD;
+        return cp;
+    } else if constexpr (sizeof(char_type) == 2) {
+        char32_t c = static_cast<char16_t>(*p++);
+        if (c >= 0xD800 && c < 0xDC00 && p != end) {
+            char32_t low = static_cast<char16_t>(*p);
+            if (low >= 0xDC00 && low < 0xE000) {
+                ++p;
+                return 0x10000 + ((c - 0xD800) << 10) + (low - 0xDC00);
+            }
+        }
+        return c >= 0xD800 && c < 0xE000 ? 0xFFFD : c;
+    } else {
+        auto c = static_cast<char32_t>(*p++);
+        return c > 0x10FFFF || (c >= 0xD800 && c < 0xE000) ? 0xFFFD : c;
+    }
+}
+// Encodes a code point as decode() would read it, calling out(c) per char
+template<typename char_type, typename Out>
+constexpr void encode(char32_t cp, Out&& out) {
+    if constexpr (sizeof(char_type) == 1) {
+        if (cp < 0x80) {
+            out(static_cast<char_type>(cp));
+            return;
+        }
+        constexpr char32_t lead[4] = { 0, 0xC0, 0xE0, 0xF0 };
+        int extra = cp < 0x800 ? 1 : cp < 0x10000 ? 2 : 3;
+        out(static_cast<char_type>(lead[extra] | (cp >> (6 * extra))));
+        for (int shift = 6 * (extra - 1); shift >= 0; shift -= 6)
+            out(static_cast<char_type>(0x80 | ((cp >> shift) & 0x3F)));
+    } else if constexpr (sizeof(char_type) == 2) {
+        if (cp < 0x10000) {
+            out(static_cast<char_type>(cp));
+        } else {
+            cp -= 0x10000;
+            out(static_cast<char_type>(0xD800 + (cp >> 10)));
+            out(static_cast<char_type>(0xDC00 + (cp & 0x3FF)));
+        }
+    } else {
+        out(static_cast<char_type>(cp));
+    }
+}
+// Transcodes [first, last) into To chars, calling out(c) per char
+template<typename To, typename From, typename Out>
+constexpr void transcode_chars(const From *first, const From *last, Out&& out) {
+    while (first != last)
+        encode<To>(decode(first, last), out);
+}
+// Transcodes a string literal into UTF-8, for utf8_storage
+template<auto Input>
+consteval auto to_utf8() {
+    constexpr auto first = Input.data;
+    constexpr auto last = Input.data + std::size(Input.data);
+    constexpr auto size = [first, last] {
+        unsigned long int n = 0;
+        transcode_chars<char>(first, last, [&n](char) { ++n; });
+        return n;
+    }();
+    char chars[size] = {};
+    unsigned long int i = 0;
+    transcode_chars<char>(first, last, [&chars, &i](char c) { chars[i++] = c; });
+    return string_container<char, size>(chars);
+}
+
+// Compares against a narrow literal
+template<typename char_type, typename End = null_sentinel>
+constexpr bool wordmatch(const char_type *str, const char *word, End end = {}) noexcept {
+    while (*word != '\0' && str != end && *str == *word)
+        ++str, ++word;
+    return str == end && *word == '\0';
+}
+
+constexpr std::uint64_t fnv1a_basis = 0xCBF29CE484222325ull;
+// 64-bit FNV-1a, used to place (section, key) pairs in the hash index.
+template<typename char_type, typename End = null_sentinel>
+constexpr std::uint64_t fnv1a(const char_type *str, End end = {},
+    std::uint64_t h = fnv1a_basis) noexcept
+{
+    for (; str != end; ++str) {
+        h ^= static_cast<std::make_unsigned_t<char_type>>(*str);
+        h *= 0x100000001B3ull;
+    }
+    return h;
+}
+// Scrambles a hash with a bucket's displacement to pick an index slot.
+constexpr std::uint64_t mix(std::uint64_t h, std::uint64_t d) noexcept {
+    h ^= d * 0x9E3779B97F4A7C15ull;
+    h = (h ^ (h >> 30)) * 0xBF58476D1CE4E5B9ull;
+    h = (h ^ (h >> 27)) * 0x94D049BB133111EBull;
+    return h ^ (h >> 31);
+}
+// FNV-1a leaves its upper bits poorly mixed, so results are finalized.
+// Scoped lookups fold a hash of the section (its scope) into the key's
+// before finalizing, so that a key hashed once (see basic_key) can be
+// looked up in any section. The scope of tryget(key) is zero.
+template<typename char_type, typename End = null_sentinel>
+constexpr std::uint64_t scope_hash(const char_type *sec, End end = {}) noexcept {
+    return mix(fnv1a(sec, end), 1);
+}
+template<typename char_type>
+constexpr std::uint64_t hash(const char_type *key) noexcept {
+    return mix(fnv1a(key), 0);
+}
+template<typename char_type>
+constexpr std::uint64_t hash(const char_type *sec, const char_type *key) noexcept {
+    return mix(fnv1a(key) ^ scope_hash(sec), 0);
+}
+// The same hashes, for strings that are not null-terminated
+template<typename char_type>
+constexpr std::uint64_t hash(std::basic_string_view<char_type> key) noexcept {
+    return mix(fnv1a(key.data(), key.data() + key.size()), 0);
+}
+template<typename char_type>
+constexpr std::uint64_t hash(std::basic_string_view<char_type> sec,
+    std::basic_string_view<char_type> key) noexcept
+{
+    return mix(fnv1a(key.data(), key.data() + key.size()) ^
+        scope_hash(sec.data(), sec.data() + sec.size()), 0);
+}
+// The scope of the given section, or of tryget(key) if nullptr
+template<typename char_type>
+constexpr std::uint64_t hash_scope(const std::basic_string_view<char_type> *sec) noexcept {
+    return sec != nullptr ? scope_hash(sec->data(), sec->data() + sec->size()) : 0;
+}
+// The short hash that kvps keep of their key, which lookups check before
+// comparing chars: the low bits of hash(key)
+template<typename char_type>
+constexpr std::uint32_t key_hash(const char_type *first, const char_type *last) noexcept {
+    return static_cast<std::uint32_t>(mix(fnv1a(first, last), 0));
+}
+// Maps a hash onto [0, n) without a division.
+constexpr unsigned int reduce(std::uint64_t h, unsigned int n) noexcept {
+    return static_cast<unsigned int>(((h & 0xFFFFFFFFull) * n) >> 32);
+}
+
+// Hints that 'p' will soon be read, where the compiler supports it
+constexpr void prefetch([[maybe_unused]] const void *p) noexcept {
+#if defined(__GNUC__) || defined(__clang__)
+    if (!std::is_constant_evaluated())
+        __builtin_prefetch(p);
+#endif
+}
+
+// Outcome of converting a string to a number. On failure, the value is
+// still what lenient conversion gives: the valid prefix, saturated.
+enum class number_status {
+    ok,
+    invalid,     // Not entirely a number of the requested kind
+    out_of_range // Saturated to the type's limits
+};
+template<typename T>
+struct number {
+    T value = T();
+    number_status status = number_status::invalid;
+};
+
+template<typename char_type, typename End>
+constexpr const char_type *find_end(const char_type *str, End end) noexcept {
+    if constexpr (std::same_as<End, null_sentinel>) {
+        while (*str != '\0')
+            ++str;
+        return str;
+    } else {
+        return end;
+    }
+}
+
+template<typename char_type>
+constexpr unsigned int digit_value(char_type c) noexcept {
+    if (c >= '0' && c <= '9')
+        return static_cast<unsigned int>(c - '0');
+    if (c >= 'a' && c <= 'f')
+        return static_cast<unsigned int>(c - 'a' + 10);
+    if (c >= 'A' && c <= 'F')
+        return static_cast<unsigned int>(c - 'A' + 10);
+    return 16;
+}
+
+// Reads eight decimal digits at once, returning false if any char is not
+// a digit (see "Fast numeric string to int", Wojciech Muła)
+inline bool parse_eight_digits(const char *p, std::uint32_t& out) noexcept {
+    std::uint64_t v;
+    std::memcpy(&v, p, sizeof(v));
+    if ((((v & 0xF0F0F0F0F0F0F0F0ull) | (((v + 0x0606060606060606ull) & 0xF0F0F0F0F0F0F0F0ull) >> 4))
+        != 0x3333333333333333ull))
+    {
+        return false;
+    }
+    v -= 0x3030303030303030ull;
+    v = v * 10 + (v >> 8);
+    v = (((v & 0x000000FF000000FFull) * (100 + (1000000ull << 32))) +
+        (((v >> 16) & 0x000000FF000000FFull) * (1 + (10000ull << 32)))) >> 32;
+    out = static_cast<std::uint32_t>(v);
+    return true;
+}
+
+// An integer's magnitude and sign, before narrowing to a type
+struct integer_scan {
+    std::uint64_t magnitude = 0;
+    bool negative = false;
+    bool overflow = false; // Magnitude exceeds 64 bits
+    bool digits = false;   // At least one digit was read
+    bool complete = false; // The entire string was read
+};
+
+// Reads an optionally signed integer in decimal, or in hex or binary with
+// a 0x or 0b prefix
+template<typename char_type>
+constexpr integer_scan scan_integer(const char_type *p, const char_type *last) noexcept {
+    integer_scan scan;
+    if (p != last && (*p == '-' || *p == '+'))
+        scan.negative = *p++ == '-';
+
+    unsigned int base = 10;
+    if (last - p >= 3 && p[0] == '0') {
+        if ((p[1] == 'x' || p[1] == 'X') && digit_value(p[2]) < 16)
+            base = 16, p += 2;
+        else if ((p[1] == 'b' || p[1] == 'B') && digit_value(p[2]) < 2)
+            base = 2, p += 2;
+    }
+
+    auto first = p;
+    if constexpr (sizeof(char_type) == 1 && std::endian::native == std::endian::little) {
+        // Up to 19 digits cannot overflow
+        if (base == 10 && !std::is_constant_evaluated()) {
+            std::uint32_t eight;
+            while (last - p >= 8 && p - first <= 11 &&
+                parse_eight_digits(reinterpret_cast<const char *>(p), eight))
+            {
+                scan.magnitude = scan.magnitude * 100000000 + eight;
+                p += 8;
+            }
+        }
+    }
+
+    for (unsigned int d; p != last && (d = digit_value(*p)) < base; ++p) {
+        if (scan.magnitude > (~std::uint64_t(0) - d) / base)
+            scan.overflow = true;
+        else if (!scan.overflow)
+            scan.magnitude = scan.magnitude * base + d;
+    }
+
+    scan.digits = p != first;
+    scan.complete = scan.digits && p == last;
+    return scan;
+}
+
+// Narrows a scanned integer to the given type, saturating at its limits
+template<std::integral int_type>
+constexpr number<int_type> to_integer(const integer_scan& scan) noexcept {
+    using unsigned_type = std::make_unsigned_t<int_type>;
+    constexpr auto max = static_cast<unsigned_type>(std::numeric_limits<int_type>::max());
+
+    number<int_type> ret;
+    ret.status = scan.complete ? number_status::ok : number_status::invalid;
+    if constexpr (std::is_unsigned_v<int_type>) {
+        if (scan.negative && (scan.magnitude != 0 || scan.overflow)) {
+            ret.value = 0;
+            if (scan.complete)
+                ret.status = number_status::out_of_range;
+            return ret;
+        }
+    }
+
+    // Signed types reach one further when negative
+    auto limit = static_cast<std::uint64_t>(max) + (std::is_signed_v<int_type> && scan.negative);
+    if (scan.overflow || scan.magnitude > limit) {
+        ret.value = scan.negative ? std::numeric_limits<int_type>::min()
+                                  : std::numeric_limits<int_type>::max();
+        if (scan.complete)
+            ret.status = number_status::out_of_range;
+    } else {
+        auto magnitude = static_cast<unsigned_type>(scan.magnitude);
+        ret.value = static_cast<int_type>(scan.negative ? unsigned_type(0) - magnitude : magnitude);
+    }
+    return ret;
+}
+
+// A decimal number split into a mantissa of up to 19 digits and a
+// base-10 exponent
+template<typename char_type>
+struct float_scan {
+    const char_type *first = nullptr; // Start of the number, past its sign
+    const char_type *last = nullptr;  // End of the number
+    std::uint64_t mantissa = 0;
+    long int exponent = 0;
+    bool negative = false;
+    bool truncated = false; // Nonzero digits were dropped from the mantissa
+    bool digits = false;
+};
+
+// Reads digits, an optional fraction, and an optional exponent
+template<typename char_type>
+constexpr float_scan<char_type> scan_float(const char_type *p, const char_type *last) noexcept {
+    float_scan<char_type> scan;
+    if (p != last && (*p == '-' || *p == '+'))
+        scan.negative = *p++ == '-';
+    scan.first = p;
+
+    int kept = 0;
+    auto digit = [&](unsigned int d, bool fraction) {
+        if (kept < 19) {
+            scan.mantissa = scan.mantissa * 10 + d;
+            kept += scan.mantissa != 0;
+            scan.exponent -= fraction;
+        } else {
+            scan.exponent += !fraction;
+            scan.truncated |= d != 0;
+        }
+    };
+
+    for (; p != last && *p >= '0' && *p <= '9'; ++p)
+        digit(static_cast<unsigned int>(*p - '0'), false);
+    scan.digits = p != scan.first;
+    if (p != last && *p == '.') {
+        auto fraction = ++p;
+        for (; p != last && *p >= '0' && *p <= '9'; ++p)
+            digit(static_cast<unsigned int>(*p - '0'), true);
+        scan.digits |= p != fraction;
+    }
+
+    if (scan.digits && p != last && (*p == 'e' || *p == 'E')) {
+        auto q = p + 1;
+        bool negative = q != last && *q == '-';
+        if (q != last && (*q == '-' || *q == '+'))
+            ++q;
+        if (q != last && *q >= '0' && *q <= '9') {
+            long int exponent = 0;
+            for (; q != last && *q >= '0' && *q <= '9'; ++q) {
+                if (exponent < 100000)
+                    exponent = exponent * 10 + (*q - '0');
+            }
+            scan.exponent += negative ? -exponent : exponent;
+            p = q;
+        }
+    }
+
+    scan.last = p;
+    return scan;
+}
+
+// A fixed-capacity unsigned big integer, for the exact conversions that
+// fall outside the fast path. 4096 bits hold any power of ten that a
+// convertible number can be scaled by, shifted for division.
+struct big_integer {
+    constexpr static int capacity = 128;
+    std::uint32_t limbs[capacity] = {};
+    int size = 0; // Limbs in use, the highest of them nonzero
+
+    // Computes *this * m + a
+    constexpr void mul_add(std::uint32_t m, std::uint32_t a) noexcept {
+        std::uint64_t carry = a;
+        for (int i = 0; i < size; ++i) {
+            auto v = std::uint64_t(limbs[i]) * m + carry;
+            limbs[i] = static_cast<std::uint32_t>(v);
+            carry = v >> 32;
+        }
+        if (carry != 0 && size < capacity)
+            limbs[size++] = static_cast<std::uint32_t>(carry);
+    }
+    constexpr void mul_pow10(long int n) noexcept {
+        constexpr std::uint32_t powers[] = {
+            1, 10, 100, 1000, 10000, 100000, 1000000, 10000000, 100000000
+        };
+        for (; n >= 9; n -= 9)
+            mul_add(1000000000, 0);
+        if (n > 0)
+            mul_add(powers[n], 0);
+    }
+    constexpr void shift_left(long int bits) noexcept {
+        if (size == 0 || bits <= 0)
+            return;
+        const auto whole = static_cast<int>(bits / 32);
+        const auto part = static_cast<int>(bits % 32);
+        const auto old = size;
+        size = std::min(capacity, size + whole + 1);
+        for (int i = size - 1; i >= 0; --i) {
+            auto src = i - whole;
+            std::uint32_t hi = src >= 0 && src < old ? limbs[src] : 0;
+            std::uint32_t lo = src >= 1 && src - 1 < old ? limbs[src - 1] : 0;
+            limbs[i] = part != 0 ? (hi << part) | (lo >> (32 - part)) : hi;
+        }
+        trim();
+    }
+    constexpr void trim() noexcept {
+        while (size > 0 && limbs[size - 1] == 0)
+            --size;
+    }
+    constexpr long int bit_length() const noexcept {
+        return size == 0 ? 0 : (size - 1) * 32L + std::bit_width(limbs[size - 1]);
+    }
+    constexpr std::strong_ordering compare(const big_integer& other) const noexcept {
+        if (size != other.size)
+            return size <=> other.size;
+        for (int i = size - 1; i >= 0; --i) {
+            if (limbs[i] != other.limbs[i])
+                return limbs[i] <=> other.limbs[i];
+        }
+        return std::strong_ordering::equal;
+    }
+    // Subtracts a smaller or equal number
+    constexpr void subtract(const big_integer& other) noexcept {
+        std::int64_t borrow = 0;
+        for (int i = 0; i < size; ++i) {
+            std::int64_t v = std::int64_t(limbs[i]) - (i < other.size ? other.limbs[i] : 0) - borrow;
+            borrow = v < 0;
+            limbs[i] = static_cast<std::uint32_t>(v + (borrow << 32));
+        }
+        trim();
+    }
+    // Returns the 64 bits starting at the given bit, and whether any bits
+    // below them are set
+    constexpr std::uint64_t bits_from(long int first, bool& below) const noexcept {
+        std::uint64_t out = 0;
+        for (int b = 63; b >= 0; --b) {
+            auto at = first + b;
+            auto limb = static_cast<int>(at / 32);
+            if (at >= 0 && limb < size)
+                out |= std::uint64_t(limbs[limb] >> (at % 32) & 1) << b;
+        }
+        below = false;
+        for (long int at = 0; !below && at < first && at / 32 < size; at += 32) {
+            auto limb = static_cast<int>(at / 32);
+            auto mask = first - at >= 32 ? ~std::uint32_t(0) : (std::uint32_t(1) << (first - at)) - 1;
+            below = (limbs[limb] & mask) != 0;
+        }
+        return out;
+    }
+};
+
+// Rounds q * 2^exponent (plus a nonzero amount below q's last bit, if
+// 'sticky') to the nearest float_type, ties to even
+template<std::floating_point float_type>
+constexpr float_type round_binary(std::uint64_t q, long int exponent, bool sticky) noexcept {
+    using limits = std::numeric_limits<float_type>;
+    constexpr long int digits = limits::digits;
+    constexpr long int min_exponent = limits::min_exponent - digits; // Of the last bit of a subnormal
+    constexpr long int max_exponent = limits::max_exponent - digits; // Of the last bit of the largest
+
+    if (q == 0)
+        return 0;
+    const long int length = std::bit_width(q);
+    auto drop = std::max(length - digits, min_exponent - exponent);
+    std::uint64_t m = q;
+    if (drop > length)
+        return 0;
+    if (drop > 0) {
+        auto rest = drop < 64 ? q & ((std::uint64_t(1) << drop) - 1) : q;
+        auto half = std::uint64_t(1) << (drop - 1);
+        m = drop < 64 ? q >> drop : 0;
+        if (rest > half || (rest == half && (sticky || (m & 1) != 0)))
+            ++m;
+        exponent += drop;
+        if (m == std::uint64_t(1) << digits) {
+            m >>= 1;
+            ++exponent;
+        }
+    } else if (drop < 0) {
+        m <<= -drop;
+        exponent += drop;
+    }
+    if (exponent > max_exponent)
+        return limits::infinity();
+
+    // Scaling by powers of two is exact, as the result is representable
+    auto value = static_cast<float_type>(m);
+    for (; exponent > 0; exponent -= std::min(exponent, 60L))
+        value *= static_cast<float_type>(std::uint64_t(1) << std::min(exponent, 60L));
+    for (; exponent < 0; exponent += std::min(-exponent, 60L))
+        value /= static_cast<float_type>(std::uint64_t(1) << std::min(-exponent, 60L));
+    return value;
+}
+
+// Converts a scanned decimal number exactly: its significant digits (up to
+// 800, past which any further nonzero digit only breaks a tie) are scaled
+// by their power of ten as big integers, and rounded once.
+template<std::floating_point float_type, typename char_type>
+constexpr float_type to_float_exact(const float_scan<char_type>& scan) noexcept {
+    constexpr int max_digits = 800;
+
+    // Gather the digits again, tracking the exponent that scan_float() added
+    // for its 19-digit mantissa, to recover the written exponent
+    big_integer digits;
+    long int exponent = 0;
+    long int scan_adjust = 0;
+    int kept = 0, scan_kept = 0;
+    bool truncated = false;
+    std::uint32_t chunk = 0;
+    int chunk_size = 0;
+    auto digit = [&](unsigned int d, bool fraction) {
+        if (scan_kept < 19) {
+            scan_kept += scan_kept != 0 || d != 0;
+            scan_adjust -= fraction;
+        } else {
+            scan_adjust += !fraction;
+        }
+        if (kept < max_digits) {
+            kept += kept != 0 || d != 0;
+            exponent -= fraction;
+            chunk = chunk * 10 + d;
+            if (++chunk_size == 9) {
+                digits.mul_add(1000000000, chunk);
+                chunk = 0;
+                chunk_size = 0;
+            }
+        } else {
+            exponent += !fraction;
+            truncated |= d != 0;
+        }
+    };
+    auto p = scan.first;
+    for (; p != scan.last && *p >= '0' && *p <= '9'; ++p)
+        digit(static_cast<unsigned int>(*p - '0'), false);
+    if (p != scan.last && *p == '.') {
+        for (++p; p != scan.last && *p >= '0' && *p <= '9'; ++p)
+            digit(static_cast<unsigned int>(*p - '0'), true);
+    }
+    digits.mul_pow10(chunk_size);
+    digits.mul_add(1, chunk);
+    exponent += scan.exponent - scan_adjust;
+
+    if (digits.size == 0)
+        return 0;
+    // Numbers beyond the range of any float_type, by their count of digits
+    if (kept + exponent > 330)
+        return std::numeric_limits<float_type>::infinity();
+    if (kept + exponent < -330)
+        return 0;
+
+    if (exponent >= 0) {
+        digits.mul_pow10(exponent);
+        auto first = std::max(digits.bit_length() - 64, 0L);
+        bool below = false;
+        auto q = digits.bits_from(first, below);
+        return round_binary<float_type>(q, first, below || truncated);
+    }
+
+    // Divide by the power of ten, keeping 55 or 56 bits of the quotient
+    big_integer divisor;
+    divisor.mul_add(1, 1);
+    divisor.mul_pow10(-exponent);
+    auto shift = divisor.bit_length() - digits.bit_length() + 55;
+    if (shift >= 0)
+        digits.shift_left(shift);
+    else
+        divisor.shift_left(-shift);
+    std::uint64_t q = 0;
+    for (int bit = 57; bit >= 0; --bit) {
+        auto part = divisor;
+        part.shift_left(bit);
+        if (digits.compare(part) >= 0) {
+            digits.subtract(part);
+            q |= std::uint64_t(1) << bit;
+        }
+    }
+    return round_binary<float_type>(q, -shift, digits.size != 0 || truncated);
+}
+
+// Converts a scanned decimal number without <charconv>, correctly rounded.
+// Numbers whose mantissa and power of ten are both exact take Clinger's
+// fast path; others are converted exactly through big integers. Types
+// wider than double are converted as a double.
+template<std::floating_point float_type, typename char_type>
+constexpr float_type to_float(const float_scan<char_type>& scan) noexcept {
+    using work_type = std::conditional_t<(sizeof(float_type) > sizeof(double)), double, float_type>;
+    constexpr work_type exact_powers[] = {
+        1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+        1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22
+    };
+    constexpr long int max_power = sizeof(work_type) >= sizeof(double) ? 22 : 10;
+    constexpr auto max_mantissa = std::uint64_t(1) << std::numeric_limits<work_type>::digits;
+
+    if (!scan.truncated && scan.mantissa <= max_mantissa &&
+        scan.exponent >= -max_power && scan.exponent <= max_power)
+    {
+        auto value = static_cast<work_type>(scan.mantissa);
+        if (scan.exponent >= 0)
+            value *= exact_powers[scan.exponent];
+        else
+            value /= exact_powers[-scan.exponent];
+        return static_cast<float_type>(value);
+    }
+    return static_cast<float_type>(to_float_exact<work_type>(scan));
+}
+
+template<std::floating_point float_type, typename char_type>
+constexpr number<float_type> to_floating(const char_type *first, const char_type *last) noexcept {
+    auto scan = scan_float(first, last);
+    number<float_type> ret;
+    if (!scan.digits)
+        return ret;
+
+    bool converted = false;
+#ifdef __cpp_lib_to_chars
+    // At run-time, <charconv> gives correctly rounded results
+    if constexpr (std::same_as<char_type, char>) {
+        if (!std::is_constant_evaluated()) {
+            auto [ptr, ec] = std::from_chars(scan.first, scan.last, ret.value);
+            if (ec == std::errc::result_out_of_range) {
+                ret.value = scan.mantissa != 0 && scan.exponent > 0 ?
+                    std::numeric_limits<float_type>::infinity() : float_type(0);
+            }
+            converted = true;
+        }
+    }
 #endif
+    if (!converted)
+        ret.value = to_float<float_type>(scan);
+
+    ret.status = scan.last == last ? number_status::ok : number_status::invalid;
+    if (ret.status == number_status::ok && (ret.value == std::numeric_limits<float_type>::infinity() ||
+        (ret.value == 0 && scan.mantissa != 0)))
+    {
+        ret.status = number_status::out_of_range;
+    }
+    if (scan.negative)
+        ret.value = -ret.value;
+    return ret;
+}
+
+// Converts a string to the given type, in the manner of from_string()
+template<typename T, typename char_type, typename End = null_sentinel>
+constexpr number<T> to_number(const char_type *str, End end = {}) noexcept {
+    auto last = find_end(str, end);
+    if constexpr (std::same_as<T, bool>) {
+        // Booleans may also be written as true/false, yes/no, or on/off
+        if (wordmatch(str, "true", last) || wordmatch(str, "yes", last) || wordmatch(str, "on", last))
+            return { true, number_status::ok };
+        if (wordmatch(str, "false", last) || wordmatch(str, "no", last) || wordmatch(str, "off", last))
+            return { false, number_status::ok };
+        auto scan = scan_integer(str, last);
+        return { scan.magnitude != 0 || scan.overflow,
+                 scan.complete ? number_status::ok : number_status::invalid };
+    } else if constexpr (std::integral<T>) {
+        return to_integer<T>(scan_integer(str, last));
+    } else {
+        return to_floating<T>(str, last);
+    }
+}
+
+// Narrows a converted double to the given floating-point type
+template<std::floating_point float_type>
+constexpr number<float_type> narrow(number<double> n) noexcept {
+    if constexpr (sizeof(float_type) >= sizeof(double)) {
+        return { n.value, n.status };
+    } else {
+        number<float_type> ret = { 0, n.status };
+        auto magnitude = n.value < 0 ? -n.value : n.value;
+        if (magnitude > std::numeric_limits<float_type>::max())
+            ret.value = std::numeric_limits<float_type>::infinity();
+        else
+            ret.value = static_cast<float_type>(magnitude);
+        bool overflow = ret.value == std::numeric_limits<float_type>::infinity();
+        bool underflow = ret.value == 0 && magnitude != 0;
+        if (ret.status == number_status::ok && (overflow || underflow))
+            ret.status = number_status::out_of_range;
+        if (n.value < 0)
+            ret.value = -ret.value;
+        return ret;
+    }
+}
+
+template<typename T>
+constexpr conversion_result<T> make_result(bool found, number<T> n) noexcept {
+    if (!found)
+        return conversion_error::missing_key;
+    switch (n.status) {
+    case number_status::ok:
+        return n.value;
+    case number_status::invalid:
+        return conversion_error::invalid_value;
+    default:
+        return conversion_error::out_of_range;
+    }
+}
+
+// Converts the given string, returning its valid prefix as a number
+// (zero if there is none). Out-of-range numbers saturate.
+template<typename T, typename char_type, typename End = null_sentinel>
+constexpr T from_string(const char_type *str, End end = {}) noexcept {
+    return to_number<T>(str, end).value;
+}
+
+// Checks if from_string<T>() would convert the entire string, in range
+template<typename T, typename char_type, typename End = null_sentinel>
+constexpr bool is_valid(const char_type *str, End end = {}) noexcept {
+    return to_number<T>(str, end).status == number_status::ok;
+}
+
+// Parsed configs keep their strings null-terminated in a kvp buffer of two
+// pools: section names and keys come first, and then values. Key scans and
+// compares never touch value bytes. The tables below locate strings by
+// offset and length, and are what iterators walk.
+template<typename offset_type>
+constexpr offset_type npos = static_cast<offset_type>(~offset_type(0));
+
+// Locations of a key-value pair's strings within the kvp buffer.
+// Key lengths and short hashes are stored so that mismatches are rejected
+// without a string compare, even among keys that share a long prefix.
+template<typename offset_type>
+struct kvp_offsets {
+    offset_type key = 0;
+    offset_type key_size = 0;
+    offset_type value = 0;
+    offset_type value_size = 0;
+    offset_type section = npos<offset_type>; // Offset of the section's name, npos if kvp
+                                             // precedes all sections
+    std::uint32_t key_hash = 0;              // See key_hash()
+};
+
+// A section directory entry, describing a section's first run of kvps.
+// Sections without any kvps are left out of the directory.
+template<typename offset_type>
+struct section_entry {
+    offset_type name = 0;  // Offset of the section's name
+    offset_type count = 0; // Number of kvps in the run
+    offset_type index = 0; // kvp table position of the run's first kvp
+};
+
+enum class parse_status {
+    ok,
+    bad_section,
+    invalid_key,
+    no_value
+};
+
+constexpr const char *parse_message(parse_status status) noexcept {
+    switch (status) {
+    case parse_status::bad_section:
+        return "Bad section tag!";
+    case parse_status::invalid_key:
+        return "Invalid key!";
+    case parse_status::no_value:
+        return "No value!";
+    default:
+        return "";
+    }
+}
+
+// Results of verify_and_size()
+struct parse_sizes {
+    unsigned int chars = 0;     // Chars needed for the kvp buffer
+    unsigned int key_chars = 0; // Chars of those in the key pool
+    unsigned int kvps = 0;     // Count of key-value pairs
+    unsigned int sections = 0; // Count of section headers
+    parse_status status = parse_status::ok;
+    unsigned int line = 0;     // Line of the error, if status is not ok
+};
+
+// Finds the first '\n' or '\0' in [p, end), comparing a block of chars at
+// a time where the target supports it
+inline const char *find_eol(const char *p, const char *end) noexcept {
+#if defined(TCSULLIVAN_INI_CONFIG_SSE2)
+#if defined(__AVX2__)
+    const auto newline32 = _mm256_set1_epi8('\n');
+    const auto zero32 = _mm256_setzero_si256();
+    for (; end - p >= 32; p += 32) {
+        auto block = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(p));
+        auto eols = _mm256_or_si256(_mm256_cmpeq_epi8(block, newline32),
+            _mm256_cmpeq_epi8(block, zero32));
+        if (auto mask = static_cast<unsigned int>(_mm256_movemask_epi8(eols)); mask != 0)
+            return p + std::countr_zero(mask);
+    }
+#endif
+    const auto newline = _mm_set1_epi8('\n');
+    const auto zero = _mm_setzero_si128();
+    for (; end - p >= 16; p += 16) {
+        auto block = _mm_loadu_si128(reinterpret_cast<const __m128i *>(p));
+        auto eols = _mm_or_si128(_mm_cmpeq_epi8(block, newline), _mm_cmpeq_epi8(block, zero));
+        if (auto mask = static_cast<unsigned int>(_mm_movemask_epi8(eols)); mask != 0)
+            return p + std::countr_zero(mask);
+    }
+#elif defined(TCSULLIVAN_INI_CONFIG_NEON)
+    const auto newline = vdupq_n_u8('\n');
+    const auto zero = vdupq_n_u8(0);
+    for (; end - p >= 16; p += 16) {
+        auto block = vld1q_u8(reinterpret_cast<const std::uint8_t *>(p));
+        auto eols = vorrq_u8(vceqq_u8(block, newline), vceqq_u8(block, zero));
+        // Narrow each byte's result to four bits of a 64-bit mask
+        auto mask = vget_lane_u64(vreinterpret_u64_u8(
+            vshrn_n_u16(vreinterpretq_u16_u8(eols), 4)), 0);
+        if (mask != 0)
+            return p + std::countr_zero(mask) / 4;
+    }
+#endif
+    while (p != end && !iseol(*p))
+        ++p;
+    return p;
+}
+
+// As find_eol(), for 2- or 4-byte chars, comparing them as 16- or 32-bit
+// lanes
+template<typename char_type>
+inline const char_type *find_eol_wide(const char_type *p, const char_type *end) noexcept {
+    static_assert(sizeof(char_type) == 2 || sizeof(char_type) == 4);
+    constexpr std::ptrdiff_t lanes = 16 / sizeof(char_type);
+#if defined(TCSULLIVAN_INI_CONFIG_SSE2)
+    const auto newline = sizeof(char_type) == 2 ? _mm_set1_epi16('\n') : _mm_set1_epi32('\n');
+    const auto zero = _mm_setzero_si128();
+    for (; end - p >= lanes; p += lanes) {
+        auto block = _mm_loadu_si128(reinterpret_cast<const __m128i *>(p));
+        auto eols = sizeof(char_type) == 2 ?
+            _mm_or_si128(_mm_cmpeq_epi16(block, newline), _mm_cmpeq_epi16(block, zero)) :
+            _mm_or_si128(_mm_cmpeq_epi32(block, newline), _mm_cmpeq_epi32(block, zero));
+        // Each char sets as many mask bits as it has bytes
+        if (auto mask = static_cast<unsigned int>(_mm_movemask_epi8(eols)); mask != 0)
+            return p + std::countr_zero(mask) / sizeof(char_type);
+    }
+#elif defined(TCSULLIVAN_INI_CONFIG_NEON)
+    for (; end - p >= lanes; p += lanes) {
+        // Narrow each char's result to half its width, in a 64-bit mask
+        std::uint64_t mask;
+        if constexpr (sizeof(char_type) == 2) {
+            auto block = vld1q_u16(reinterpret_cast<const std::uint16_t *>(p));
+            auto eols = vorrq_u16(vceqq_u16(block, vdupq_n_u16('\n')), vceqq_u16(block, vdupq_n_u16(0)));
+            mask = vget_lane_u64(vreinterpret_u64_u8(vmovn_u16(eols)), 0);
+        } else {
+            auto block = vld1q_u32(reinterpret_cast<const std::uint32_t *>(p));
+            auto eols = vorrq_u32(vceqq_u32(block, vdupq_n_u32('\n')), vceqq_u32(block, vdupq_n_u32(0)));
+            mask = vget_lane_u64(vreinterpret_u64_u16(vmovn_u32(eols)), 0);
+        }
+        if (mask != 0)
+            return p + std::countr_zero(mask) / (sizeof(char_type) * 4);
+    }
+#endif
+    while (p != end && !iseol(*p))
+        ++p;
+    return p;
+}
+
+// Finds the end of the line starting at 'line'. Text may end with or
+// without a null terminator.
+template<typename char_type>
+constexpr const char_type *lineend(const char_type *line, const char_type *end) noexcept {
+    if constexpr (sizeof(char_type) == 1) {
+        if (!std::is_constant_evaluated()) {
+            auto first = reinterpret_cast<const char *>(line);
+            return line + (find_eol(first, reinterpret_cast<const char *>(end)) - first);
+        }
+    } else if constexpr (sizeof(char_type) == 2 || sizeof(char_type) == 4) {
+        if (!std::is_constant_evaluated())
+            return find_eol_wide(line, end);
+    }
+
+    while (line != end && !iseol(*line))
+        ++line;
+    return line;
+}
+
+// The INI grammar: validates the text in [begin, end), calling
+// on_section(name, name_end) for each section header and
+// on_kvp(key, key_end, value, value_end) for each key-value pair.
+// Stops at the first syntax error, returning its status and line.
+template<typename char_type, typename SectionFn, typename KvpFn>
+constexpr parse_sizes tokenize(const char_type *begin, const char_type *end,
+    SectionFn&& on_section, KvpFn&& on_kvp)
+{
+    parse_sizes sizes;
+
+    for (auto line = begin; line != end;) {
+        auto eol = lineend(line, end);
+        auto p = line;
+        line = eol != end ? eol + 1 : end;
+        ++sizes.line;
+
+        // Remove beginning whitespace
+        for (; p != eol && !isgraph(*p); ++p);
+
+        if (p == eol || iscomment(*p))
+            continue;
+
+        // Check for section header
+        if (*p == '[') {
+            auto name = ++p;
+            for (; p != eol && *p != ']'; ++p);
+            if (p == eol) {
+                sizes.status = parse_status::bad_section;
+                return sizes;
+            }
+            on_section(name, p);
+            sizes.chars += static_cast<unsigned int>(p - name) + 1;
+            sizes.key_chars += static_cast<unsigned int>(p - name) + 1;
+            ++sizes.sections;
+            continue;
+        }
+
+        // This is the key (and whitespace until =)
+        auto key = p;
+        for (; p != eol && *p != '=' && isgraph(*p); ++p);
+        auto key_end = p;
+        for (; p != eol && *p != '='; ++p) {
+            if (isgraph(*p)) {
+                sizes.status = parse_status::invalid_key;
+                return sizes;
+            }
+        }
+        if (p == eol) {
+            sizes.status = parse_status::invalid_key;
+            return sizes;
+        }
+        ++p;
+
+        // Next is the value
+        for (; p != eol && !isgraph(*p); ++p);
+        if (p == eol) {
+            sizes.status = parse_status::no_value;
+            return sizes;
+        }
+        on_kvp(key, key_end, p, eol);
+
+        // All good, add two chars for key/value terminators
+        sizes.chars += static_cast<unsigned int>((key_end - key) + (eol - p)) + 2;
+        sizes.key_chars += static_cast<unsigned int>(key_end - key) + 1;
+        ++sizes.kvps;
+    }
+
+    sizes.line = 0;
+    return sizes;
+}
+
+// Chooses which parts of the text a config keeps: sections (the
+// unnamed one holding keys above any header is given as an empty
+// range), and the text of values. Configs keep everything by default.
+struct keep_all {
+    template<typename char_type>
+    constexpr bool section(const char_type *, const char_type *) const noexcept {
+        return true;
+    }
+    template<typename char_type>
+    constexpr bool value(const char_type *, const char_type *) const noexcept {
+        return true;
+    }
+};
+
+// Runs tokenize(), passing on only the sections that 'filter' keeps and
+// their kvps. Sizes count only what is kept, though the whole text is
+// still validated.
+template<typename char_type, typename Filter, typename SectionFn, typename KvpFn>
+constexpr parse_sizes tokenize_kept(const char_type *begin, const char_type *end,
+    const Filter& filter, SectionFn&& on_section, KvpFn&& on_kvp)
+{
+    if constexpr (std::same_as<Filter, keep_all>) {
+        return tokenize(begin, end, on_section, on_kvp);
+    } else {
+        parse_sizes kept;
+        bool keep = filter.section(begin, begin);
+        auto sizes = tokenize(begin, end,
+            [&](auto name, auto name_end) {
+                keep = filter.section(name, name_end);
+                if (!keep)
+                    return;
+                on_section(name, name_end);
+                kept.chars += static_cast<unsigned int>(name_end - name) + 1;
+                kept.key_chars += static_cast<unsigned int>(name_end - name) + 1;
+                ++kept.sections;
+            },
+            [&](auto key, auto key_end, auto value, auto value_end) {
+                if (!keep)
+                    return;
+                on_kvp(key, key_end, value, value_end);
+                auto text = filter.value(value, value_end) ? value_end - value : 0;
+                kept.chars += static_cast<unsigned int>((key_end - key) + text) + 2;
+                kept.key_chars += static_cast<unsigned int>(key_end - key) + 1;
+                ++kept.kvps;
+            });
+        kept.status = sizes.status;
+        kept.line = sizes.line;
+        return kept;
+    }
+}
+
+// Validates INI syntax, returning the count of chars needed to store all
+// section names, keys, and values, along with the kvp and section counts
+template<typename char_type, typename Filter = keep_all>
+constexpr parse_sizes verify_and_size(const char_type *begin, const char_type *end,
+    const Filter& filter = {}) noexcept
+{
+    return tokenize_kept(begin, end, filter, [](auto, auto) {}, [](auto, auto, auto, auto) {});
+}
+
+// The size of the hash table that section_finder is given for a text with
+// the given count of section headers: a power of two at least twice as large
+constexpr std::size_t section_slots(unsigned int sections) noexcept {
+    return sections != 0 ? std::bit_ceil(std::size_t(sections) * 2) : 0;
+}
+
+// Finds each section's directory entry as a run of its kvps starts, so that
+// only a section's first run is entered. Given a table of section_slots()
+// slots, sections are found through a hash of their name, keeping a fill
+// with many sections linear. At compile-time, or without a table, the
+// entries are searched in turn.
+template<typename entry_type>
+class section_finder {
+    entry_type *m_entries;
+    unsigned int m_count = 0;
+    std::span<std::uint32_t> m_slots; // Entry index + 1, or 0 if free
+public:
+    constexpr section_finder(entry_type *entries, std::span<std::uint32_t> slots) noexcept
+        : m_entries(entries), m_slots(slots)
+    {
+        for (auto& s : m_slots)
+            s = 0;
+    }
+
+    constexpr unsigned int count() const noexcept {
+        return m_count;
+    }
+
+    // The entry added last
+    constexpr entry_type& back() const noexcept {
+        return m_entries[m_count - 1];
+    }
+
+    // Adds an entry for the section of the given name hash, returning true,
+    // if no entry is 'same' as it
+    template<typename Same>
+    constexpr bool claim(std::uint32_t hash, Same same) noexcept {
+        if (std::is_constant_evaluated() || m_slots.empty()) {
+            for (auto e = m_entries; e != m_entries + m_count; ++e) {
+                if (same(*e))
+                    return false;
+            }
+            ++m_count;
+            return true;
+        }
+
+        const auto mask = m_slots.size() - 1;
+        for (auto i = hash & mask;; i = (i + 1) & mask) {
+            if (m_slots[i] == 0) {
+                m_slots[i] = ++m_count;
+                return true;
+            }
+            if (same(m_entries[m_slots[i] - 1]))
+                return false;
+        }
+    }
+};
+
+// Fills the kvp buffer, kvp table, and section directory from text that
+// passed verify_and_size() with the same filter, given its key_chars.
+// 'slots' is the section_finder table, if any. Returns the count of section
+// directory entries.
+template<typename char_type, typename offset_type, typename Filter = keep_all>
+constexpr unsigned int fill_kvp_buffer(const char_type *begin, const char_type *end,
+    unsigned int key_chars, char_type *buffer, kvp_offsets<offset_type> *kvps,
+    section_entry<offset_type> *sections, const Filter& filter = {},
+    std::span<std::uint32_t> slots = {}) noexcept
+{
+    constexpr auto none = npos<offset_type>;
+    auto bptr = buffer;
+    auto vptr = buffer + key_chars;
+    auto kptr = kvps;
+    auto section = none;
+    std::uint32_t section_hash = 0;
+    section_finder finder(sections, slots);
+    // Set while in a section's first run
+    // (tracked with a flag, as GCC rejects comparing 'run' to nullptr here)
+    auto run = sections;
+    bool inrun = false;
+
+    auto copy = [](auto& out, auto first, auto last) {
+        while (first != last)
+            *out++ = *first++;
+        *out++ = '\0';
+    };
+
+    tokenize_kept(begin, end, filter,
+        [&](auto name, auto name_end) {
+            section = static_cast<offset_type>(bptr - buffer);
+            section_hash = key_hash(name, name_end);
+            copy(bptr, name, name_end);
+        },
+        [&](auto key, auto key_end, auto value, auto value_end) {
+            if (!filter.value(value, value_end))
+                value_end = value;
+
+            // Check if this kvp starts a new run of a section
+            if (section == none) {
+                inrun = false;
+            } else if (kptr == kvps || (kptr - 1)->section == none ||
+                ((kptr - 1)->section != section && !stringmatch(
+                    buffer + (kptr - 1)->section, buffer + section)))
+            {
+                inrun = finder.claim(section_hash, [&](const auto& e) {
+                    return stringmatch(buffer + e.name, buffer + section);
+                });
+                if (inrun) {
+                    run = &finder.back();
+                    run->name = section;
+                    run->index = static_cast<offset_type>(kptr - kvps);
+                }
+            }
+
+            kptr->key = static_cast<offset_type>(bptr - buffer);
+            kptr->key_size = static_cast<offset_type>(key_end - key);
+            kptr->value = static_cast<offset_type>(vptr - buffer);
+            kptr->value_size = static_cast<offset_type>(value_end - value);
+            kptr->section = section;
+            kptr->key_hash = key_hash(key, key_end);
+            copy(bptr, key, key_end);
+            copy(vptr, value, value_end);
+            ++kptr;
+
+            if (inrun)
+                ++run->count;
+        });
+
+    return finder.count();
+}
+
+// A kvp listed by a profile, and the lookups that find it: tryget(key) if
+// 'global', and tryget(section, key) if 'scoped'
+template<typename index_entry>
+struct hot_kvp {
+    index_entry kvp = 0;
+    bool global = false;
+    bool scoped = false;
+};
+
+// Moves the strings of the given kvps (hottest first) to the front of the
+// key and value pools of a filled buffer, so that they share its first cache
+// lines: each kvp's key and section name, then its value. Other strings keep
+// their order, and all offsets are updated. 'chars' counts the chars in use.
+template<typename char_type, typename offset_type, typename Scratch>
+constexpr void pack_hot(char_type *buffer, unsigned int chars, unsigned int key_chars,
+    kvp_offsets<offset_type> *kvps, unsigned int kvp_count,
+    section_entry<offset_type> *sections, unsigned int section_count,
+    const unsigned int *hot, unsigned int hot_count, const Scratch& scratch) noexcept
+{
+    constexpr auto none = npos<offset_type>;
+    auto packed = scratch.template make<char_type>(chars);
+    auto moved = scratch.template make<offset_type>(chars); // New offsets, by old offset
+    for (unsigned int i = 0; i < chars; ++i)
+        moved[i] = none;
+
+    unsigned int at = 0;
+    auto move = [&](unsigned int from) {
+        if (from == none || moved[from] != none)
+            return;
+        moved[from] = static_cast<offset_type>(at);
+        do
+            packed[at++] = buffer[from];
+        while (buffer[from++] != '\0');
+    };
+    auto move_rest = [&](unsigned int first, unsigned int last) {
+        for (auto i = first; i < last; ++i) {
+            if (i == first || buffer[i - 1] == '\0')
+                move(i);
+        }
+    };
+
+    for (unsigned int h = 0; h < hot_count; ++h) {
+        move(kvps[hot[h]].key);
+        move(kvps[hot[h]].section);
+    }
+    move_rest(0, key_chars);
+    for (unsigned int h = 0; h < hot_count; ++h)
+        move(kvps[hot[h]].value);
+    move_rest(key_chars, chars);
+
+    for (unsigned int i = 0; i < kvp_count; ++i) {
+        auto& k = kvps[i];
+        k.key = moved[k.key];
+        k.value = moved[k.value];
+        if (k.section != none)
+            k.section = moved[k.section];
+    }
+    for (unsigned int i = 0; i < section_count; ++i)
+        sections[i].name = moved[sections[i].name];
+    for (unsigned int i = 0; i < chars; ++i)
+        buffer[i] = packed[i];
+}
+
+// Stores a key-value pair, including a section identifier
+template<typename char_type>
+struct kvp {
+    const char_type *section = nullptr;
+    const char_type *first = nullptr;
+    const char_type *second = nullptr;
+};
+
+template<typename char_type, typename offset_type>
+constexpr kvp<char_type> make_kvp(const char_type *buffer, const kvp_offsets<offset_type>& e) noexcept {
+    return {
+        e.section != npos<offset_type> ? buffer + e.section : nullptr,
+        buffer + e.key,
+        buffer + e.value
+    };
+}
+
+// Gives operator-> something to point at when dereferencing makes a value
+template<typename T>
+struct arrow_proxy {
+    T value;
+    constexpr const T *operator->() const noexcept {
+        return &value;
+    }
+};
+
+// Walks a kvp table, building each kvp from its offsets when dereferenced.
+// Stepping is an index increment, so this models std::random_access_iterator
+// for ranges. Dereferencing yields a value rather than a reference, which
+// the Cpp17 forward iterator requirements forbid, so legacy algorithms see
+// an input iterator.
+template<typename char_type, typename entry_type>
+class iterator {
+    const char_type *m_text = nullptr;
+    const entry_type *m_pos = nullptr;
+
+public:
+    using difference_type = std::ptrdiff_t;
+    using value_type = decltype(make_kvp(m_text, *m_pos));
+    using iterator_concept = std::random_access_iterator_tag;
+    using iterator_category = std::input_iterator_tag;
+
+    // 'pos' is an entry in the kvp table, whose offsets are into 'text'
+    constexpr iterator(const char_type *text, const entry_type *pos) noexcept
+        : m_text(text), m_pos(pos) {}
+    constexpr iterator() = default;
+
+    constexpr value_type operator*() const noexcept {
+        return make_kvp(m_text, *m_pos);
+    }
+    constexpr auto operator->() const noexcept {
+        return arrow_proxy<value_type>{**this};
+    }
+    constexpr value_type operator[](difference_type n) const noexcept {
+        return make_kvp(m_text, m_pos[n]);
+    }
+
+    constexpr auto& operator++() noexcept {
+        ++m_pos;
+        return *this;
+    }
+    constexpr auto operator++(int) noexcept {
+        auto copy = *this;
+        ++m_pos;
+        return copy;
+    }
+    constexpr auto& operator--() noexcept {
+        --m_pos;
+        return *this;
+    }
+    constexpr auto operator--(int) noexcept {
+        auto copy = *this;
+        --m_pos;
+        return copy;
+    }
+    constexpr auto& operator+=(difference_type n) noexcept {
+        m_pos += n;
+        return *this;
+    }
+    constexpr auto& operator-=(difference_type n) noexcept {
+        m_pos -= n;
+        return *this;
+    }
+    friend constexpr iterator operator+(iterator it, difference_type n) noexcept {
+        return it += n;
+    }
+    friend constexpr iterator operator+(difference_type n, iterator it) noexcept {
+        return it += n;
+    }
+    friend constexpr iterator operator-(iterator it, difference_type n) noexcept {
+        return it -= n;
+    }
+    friend constexpr difference_type operator-(const iterator& a, const iterator& b) noexcept {
+        return a.m_pos - b.m_pos;
+    }
+
+    constexpr auto operator<=>(const iterator& other) const noexcept {
+        return m_pos <=> other.m_pos;
+    }
+    constexpr bool operator==(const iterator& other) const noexcept {
+        return m_pos == other.m_pos;
+    }
+};
+
+template<typename iterator_type>
+class section_view {
+    iterator_type m_begin;
+    iterator_type m_end;
+    unsigned int m_size = 0;
+public:
+    constexpr section_view(iterator_type b, iterator_type e, unsigned int size) noexcept
+        : m_begin(b), m_end(e), m_size(size) {}
+    constexpr auto begin() const noexcept {
+        return m_begin;
+    }
+    constexpr auto end() const noexcept {
+        return m_end;
+    }
+    constexpr auto size() const noexcept {
+        return m_size;
+    }
+    constexpr auto operator[](unsigned int i) const noexcept {
+        return m_begin[i];
+    }
+};
+
+// The lookup index holds one entry per distinct key (for tryget(key))
+// and one per distinct key of a section's first run (for tryget(sec, key)).
+constexpr unsigned int index_capacity(unsigned int kvps) noexcept {
+    return kvps * 2;
+}
+template<typename index_policy>
+constexpr unsigned int index_size(unsigned int kvps) noexcept {
+    if constexpr (std::same_as<index_policy, perfect_hash_index>)
+        return index_capacity(kvps) + index_capacity(kvps) / 4 + 1;
+    else if constexpr (std::same_as<index_policy, sorted_index>)
+        return index_capacity(kvps);
+    else
+        return 0;
+}
+template<typename index_policy>
+constexpr unsigned int index_buckets(unsigned int kvps) noexcept {
+    if constexpr (std::same_as<index_policy, perfect_hash_index>)
+        return index_capacity(kvps) / 4 + 1;
+    else
+        return 0;
+}
+
+// A non-owning view of a parsed config's kvp buffer, tables, and lookup
+// index, through which both config types do their lookups.
+// Index entries are kvp table positions, flagged if they answer tryget(key).
+template<typename char_type, typename offset_type, typename index_entry, typename index_policy>
+struct layout {
+    using entry_type = index_entry;
+    using view_type = std::basic_string_view<char_type>;
+
+    constexpr static bool use_hash = std::same_as<index_policy, perfect_hash_index>;
+    constexpr static bool use_sorted = std::same_as<index_policy, sorted_index>;
+    constexpr static index_entry index_global =
+        static_cast<index_entry>(index_entry(1) << (sizeof(index_entry) * 8 - 1));
+    constexpr static index_entry index_empty = static_cast<index_entry>(~index_entry(0));
+    constexpr static unsigned int no_kvp = ~0u;
+
+    const char_type *buffer = nullptr;
+    const kvp_offsets<offset_type> *kvps = nullptr;
+    unsigned int kvp_count = 0;
+    const section_entry<offset_type> *sections = nullptr;
+    unsigned int section_count = 0;
+    const index_entry *index = nullptr;
+    unsigned int index_size = 0; // Hash slots, or sorted entries
+    const std::uint16_t *seeds = nullptr;
+    unsigned int bucket_count = 0;
+
+    // Orders strings by length first, so that unequal lengths settle a
+    // compare before any chars are read
+    constexpr static std::strong_ordering compare_views(view_type a, view_type b) noexcept {
+        if (auto comp = a.size() <=> b.size(); comp != 0)
+            return comp;
+        return a.compare(b) <=> 0;
+    }
+
+    constexpr view_type entry_section(index_entry e) const noexcept {
+        return view_type(buffer + kvps[e].section);
+    }
+    constexpr view_type entry_key(index_entry e) const noexcept {
+        const auto& kvp = kvps[e & ~index_global];
+        return view_type(buffer + kvp.key, kvp.key_size);
+    }
+    constexpr std::uint64_t entry_hash(index_entry e) const noexcept {
+        return (e & index_global) ? hash(entry_key(e)) : hash(entry_section(e), entry_key(e));
+    }
+    // Orders index entries by section and key; entries answering tryget(key)
+    // (where 'sec' is nullptr) come first.
+    constexpr std::strong_ordering compare_scope(index_entry e, const view_type *sec) const noexcept {
+        if (bool global = e & index_global; global != (sec == nullptr))
+            return global ? std::strong_ordering::less : std::strong_ordering::greater;
+        return sec != nullptr ? compare_views(entry_section(e), *sec) : std::strong_ordering::equal;
+    }
+    constexpr std::strong_ordering compare_key(index_entry e, view_type key) const noexcept {
+        return compare_views(entry_key(e), key);
+    }
+    constexpr std::strong_ordering compare_entry(index_entry e, const view_type *sec,
+        view_type key) const noexcept
+    {
+        if (auto comp = compare_scope(e, sec); comp != 0)
+            return comp;
+        return compare_key(e, key);
+    }
+    // Compares two entries as compare_entry() would.
+    constexpr std::strong_ordering compare_entries(index_entry a, index_entry b) const noexcept {
+        if (bool global = a & index_global; global != bool(b & index_global))
+            return global ? std::strong_ordering::less : std::strong_ordering::greater;
+        if (!(a & index_global)) {
+            if (auto comp = compare_views(entry_section(a), entry_section(b)); comp != 0)
+                return comp;
+        }
+        return compare_views(entry_key(a), entry_key(b));
+    }
+    // Checks an entry against a lookup, comparing key hashes and lengths
+    // before any chars, and keys before sections
+    constexpr bool entry_matches(index_entry e, const view_type *sec, view_type key,
+        std::uint32_t key_hash) const noexcept
+    {
+        if (bool(e & index_global) != (sec == nullptr) || kvps[e & ~index_global].key_hash != key_hash ||
+            !equal_views(entry_key(e), key))
+        {
+            return false;
+        }
+        return sec == nullptr || stringmatch(buffer + kvps[e].section, *sec);
+    }
+
+    // Lists each kvp once for tryget(key), and again for tryget(sec, key) if
+    // it is in the section directory. Returns the entry count.
+    constexpr unsigned int collect_entries(index_entry *out) const noexcept {
+        unsigned int count = 0;
+
+        auto run = sections;
+        auto runs_end = sections + section_count;
+        for (unsigned int i = 0; i < kvp_count; ++i) {
+            out[count++] = static_cast<index_entry>(i | index_global);
+
+            // Sections are only searched up to the end of their first run,
+            // and the directory lists those runs in order
+            while (run != runs_end && i >= run->index + run->count)
+                ++run;
+            if (run != runs_end && i >= run->index)
+                out[count++] = static_cast<index_entry>(i);
+        }
+
+        return count;
+    }
+
+    constexpr const section_entry<offset_type> *find_section(const char_type *section) const noexcept {
+        for (unsigned int i = 0; i < section_count; ++i) {
+            if (stringmatch(buffer + sections[i].name, section))
+                return sections + i;
+        }
+        return nullptr;
+    }
+    constexpr const section_entry<offset_type> *find_section(view_type section) const noexcept {
+        for (unsigned int i = 0; i < section_count; ++i) {
+            if (stringmatch(buffer + sections[i].name, section))
+                return sections + i;
+        }
+        return nullptr;
+    }
+
+    // Finds the kvp table position of the given key through the lookup
+    // index, or no_kvp. 'sec' may be nullptr to search all sections.
+    constexpr unsigned int find_kvp(std::nullptr_t, const basic_key<char_type>& key) const noexcept {
+        return find_kvp(static_cast<const view_type *>(nullptr), key);
+    }
+    constexpr unsigned int find_kvp(const char_type *sec, const basic_key<char_type>& key) const noexcept {
+        if (sec == nullptr)
+            return find_kvp(nullptr, key);
+        auto s = view_type(sec);
+        return find_kvp(&s, key);
+    }
+    constexpr unsigned int find_kvp(const view_type *sec, const basic_key<char_type>& key) const noexcept {
+        const auto name = key.name();
+        if constexpr (use_hash) {
+            // One hash, one probe, one compare
+            if (bucket_count != 0) [[likely]] {
+                auto h = key.hash(hash_scope(sec));
+                auto d = seeds[reduce(h >> 32, bucket_count)];
+                auto e = index[reduce(mix(h, d), index_size)];
+                if (e == index_empty || !entry_matches(e, sec, name, key.short_hash()))
+                    return no_kvp;
+                return e & ~index_global;
+            }
+        }
+        if constexpr (use_hash || use_sorted) {
+            auto last = index + index_size;
+            auto it = std::lower_bound(index, last, name,
+                [this, sec](auto e, auto k) { return compare_entry(e, sec, k) < 0; });
+            if (it == last || !entry_matches(*it, sec, name, key.short_hash()))
+                return no_kvp;
+            return *it & ~index_global;
+        } else {
+            unsigned int first = 0;
+            unsigned int last = kvp_count;
+            if (sec != nullptr) {
+                auto run = find_section(*sec);
+                if (run == nullptr)
+                    return no_kvp;
+                first = run->index;
+                last = first + run->count;
+            }
+            for (auto i = first; i < last; ++i) {
+                if (kvps[i].key_hash == key.short_hash() && equal_views(entry_key(i), name))
+                {
+                    return i;
+                }
+            }
+            return no_kvp;
+        }
+    }
+    // Views the value of the given kvp, using its stored length
+    constexpr view_type value_of(unsigned int i) const noexcept {
+        return i != no_kvp ? view_type(buffer + kvps[i].value, kvps[i].value_size) : view_type();
+    }
+
+    // Counts the chars of the kvp buffer in use, which end with the last
+    // value in the value pool (the last kvp's, unless a profile moved it)
+    constexpr unsigned int buffer_size() const noexcept {
+        unsigned int size = 1;
+        for (unsigned int i = 0; i < kvp_count; ++i)
+            size = std::max(size, static_cast<unsigned int>(kvps[i].value + kvps[i].value_size + 1));
+        return size;
+    }
+
+    constexpr auto begin(unsigned int i = 0) const noexcept {
+        return iterator<char_type, kvp_offsets<offset_type>>(buffer, kvps + i);
+    }
+    constexpr auto end() const noexcept {
+        return begin(kvp_count);
+    }
+    constexpr auto begin(const section_entry<offset_type>& section) const noexcept {
+        return begin(section.index);
+    }
+    constexpr auto end(const section_entry<offset_type>& section) const noexcept {
+        return begin(section.index + section.count);
+    }
+    template<typename Name>
+    constexpr auto section(Name name) const noexcept {
+        using view = section_view<decltype(begin())>;
+        auto sec = find_section(name);
+        return sec != nullptr ? view(begin(*sec), end(*sec), sec->count) : view(end(), end(), 0);
+    }
+};
+
+// The tables of an empty run-time config: an empty kvp buffer, and an
+// index whose lookups all miss
+template<typename layout_type>
+struct empty_tables {
+    constexpr static typename layout_type::view_type::value_type buffer[1] = {};
+    constexpr static typename layout_type::entry_type index[1] = { layout_type::index_empty };
+    constexpr static std::uint16_t seeds[1] = {};
+};
+// Returns the layout of an empty run-time config, which moved-from configs
+// are also left with
+template<typename layout_type>
+constexpr layout_type empty_layout() noexcept {
+    using tables = empty_tables<layout_type>;
+    constexpr unsigned int slots = layout_type::use_hash ? 1 : 0;
+    return { tables::buffer, nullptr, 0, nullptr, 0, tables::index, slots, tables::seeds, slots };
+}
+
+// Makes fixed-size scratch arrays for building an index at compile-time
+template<std::size_t N>
+struct fixed_scratch {
+    template<typename T>
+    constexpr std::array<T, N> make(std::size_t) const noexcept {
+        return {};
+    }
+};
+// Builds the perfect hash index by "hash, displace": entries are grouped
+// into buckets by hash, then each bucket (largest first) searches for a
+// displacement that moves all of its entries into free slots.
+// Returns false if some bucket could not be placed (e.g. two keys share a
+// 64-bit hash).
+template<typename layout_type, typename Scratch>
+constexpr bool build_hash_index(const layout_type& l,
+    typename layout_type::entry_type *slots, std::uint16_t *seeds, const Scratch& scratch)
+{
+    const auto capacity = index_capacity(l.kvp_count);
+    const auto buckets = l.bucket_count;
+
+    auto entries = scratch.template make<typename layout_type::entry_type>(capacity);
+    auto hashes = scratch.template make<std::uint64_t>(capacity);
+    auto ecount = l.collect_entries(entries.data());
+    for (unsigned int i = 0; i < ecount; ++i)
+        hashes[i] = l.entry_hash(entries[i]);
+
+    // Sort entries into buckets, dropping any that repeat an earlier
+    // entry (only the first match is ever returned).
+    auto bstart = scratch.template make<unsigned int>(buckets + 1);
+    auto border = scratch.template make<unsigned int>(capacity);
+    for (unsigned int i = 0; i < ecount; ++i)
+        ++bstart[reduce(hashes[i] >> 32, buckets) + 1];
+    for (unsigned int b = 0; b < buckets; ++b)
+        bstart[b + 1] += bstart[b];
+    auto bsize = scratch.template make<unsigned int>(buckets);
+    for (unsigned int i = 0; i < ecount; ++i) {
+        auto b = reduce(hashes[i] >> 32, buckets);
+        bool repeat = false;
+        for (unsigned int j = bstart[b]; !repeat && j < bstart[b] + bsize[b]; ++j) {
+            repeat = hashes[border[j]] == hashes[i] &&
+                l.compare_entries(entries[border[j]], entries[i]) == 0;
+        }
+        if (!repeat)
+            border[bstart[b] + bsize[b]++] = i;
+    }
+
+    // Queue the buckets largest first with a counting sort
+    auto bysize = scratch.template make<unsigned int>(capacity + 1);
+    for (unsigned int b = 0; b < buckets; ++b)
+        ++bysize[bsize[b]];
+    for (unsigned int n = capacity + 1, pos = 0; n-- > 0;) {
+        auto count = bysize[n];
+        bysize[n] = pos;
+        pos += count;
+    }
+    auto bqueue = scratch.template make<unsigned int>(buckets);
+    for (unsigned int b = 0; b < buckets; ++b)
+        bqueue[bysize[bsize[b]]++] = b;
+
+    for (unsigned int i = 0; i < l.index_size; ++i)
+        slots[i] = layout_type::index_empty;
+    auto placing = scratch.template make<unsigned int>(capacity);
+    for (unsigned int q = 0; q < buckets; ++q) {
+        auto b = bqueue[q];
+        if (bsize[b] == 0)
+            break;
+
+        // Entries with equal hashes land together under every displacement
+        for (unsigned int j = 1; j < bsize[b]; ++j) {
+            for (unsigned int k = 0; k < j; ++k) {
+                if (hashes[border[bstart[b] + j]] == hashes[border[bstart[b] + k]])
+                    return false;
+            }
+        }
+
+        for (std::uint32_t d = 0;; ++d) {
+            if (d > 0xFFFF)
+                return false;
+
+            bool placed = true;
+            for (unsigned int j = 0; placed && j < bsize[b]; ++j) {
+                placing[j] = reduce(mix(hashes[border[bstart[b] + j]], d), l.index_size);
+                placed = slots[placing[j]] == layout_type::index_empty;
+                for (unsigned int k = 0; placed && k < j; ++k)
+                    placed = placing[k] != placing[j];
+            }
+            if (placed) {
+                for (unsigned int j = 0; j < bsize[b]; ++j)
+                    slots[placing[j]] = entries[border[bstart[b] + j]];
+                seeds[b] = static_cast<std::uint16_t>(d);
+                break;
+            }
+        }
+    }
+
+    return true;
+}
+
+// Builds the sorted index: entries are ordered by compare_entry(), and
+// only the first of any equal entries is kept. Returns the entry count.
+template<typename layout_type>
+constexpr unsigned int build_sorted_index(const layout_type& l,
+    typename layout_type::entry_type *out)
+{
+    constexpr auto global = layout_type::index_global;
+    auto first = out;
+    auto last = first + l.collect_entries(out);
+    std::sort(first, last, [&l](auto a, auto b) {
+        auto comp = l.compare_entries(a, b);
+        return comp != 0 ? comp < 0 : (a & ~global) < (b & ~global);
+    });
+    last = std::unique(first, last, [&l](auto a, auto b) {
+        return l.compare_entries(a, b) == 0;
+    });
+    return static_cast<unsigned int>(last - first);
+}
+
+// Builds the perfect hash index into the layout's slots and seeds. If it
+// cannot be built, a sorted index is built into the slots instead (which
+// always fit one), and marked by a bucket count of zero; lookups then
+// search it as sorted_index would, so no valid config is rejected.
+template<typename layout_type, typename Scratch>
+constexpr void build_hash_or_sorted_index(layout_type& l,
+    typename layout_type::entry_type *slots, std::uint16_t *seeds, const Scratch& scratch)
+{
+    if (!build_hash_index(l, slots, seeds, scratch)) {
+        l.index_size = build_sorted_index(l, slots);
+        l.bucket_count = 0;
+    }
+}
+
+// Implements find_many() over a sorted index, searching only the scope's
+// entries
+template<typename layout_type, typename key_type, typename VisitFn>
+constexpr void find_many_sorted(const layout_type& l, const typename layout_type::view_type *sec,
+    const key_type *keys, std::size_t count, VisitFn& visit)
+{
+    using view_type = typename layout_type::view_type;
+    auto lo = std::partition_point(l.index, l.index + l.index_size,
+        [&l, sec](auto e) { return l.compare_scope(e, sec) < 0; });
+    auto hi = std::partition_point(lo, l.index + l.index_size,
+        [&l, sec](auto e) { return l.compare_scope(e, sec) == 0; });
+    for (std::size_t i = 0; i < count; ++i) {
+        auto key = view_type(keys[i]);
+        auto it = std::lower_bound(lo, hi, key,
+            [&l](auto e, auto k) { return l.compare_key(e, k) < 0; });
+        visit(i, it != hi && l.compare_key(*it, key) == 0 ? *it & ~layout_type::index_global : layout_type::no_kvp);
+    }
+}
+
+// Looks up count keys of one scope (a section, or all sections if 'sec' is
+// nullptr), calling visit(i, kvp) with each key's kvp table position or
+// no_kvp. Keys may be null-terminated strings or string views.
+// The scope is resolved once: hash lookups fold the section's hash into
+// each key's, and probe in blocks so that the loads of a block's keys
+// overlap; sorted lookups search only the scope's entries; linear lookups
+// scan only the section's run.
+template<typename layout_type, typename key_type, typename VisitFn>
+constexpr void find_many(const layout_type& l, const typename layout_type::view_type *sec,
+    const key_type *keys, std::size_t count, VisitFn&& visit)
+{
+    using view_type = typename layout_type::view_type;
+    constexpr auto no_kvp = layout_type::no_kvp;
+
+    if constexpr (layout_type::use_hash) {
+        if (l.bucket_count == 0) [[unlikely]] {
+            find_many_sorted(l, sec, keys, count, visit);
+            return;
+        }
+        constexpr std::size_t block = 8;
+        const auto scope = hash_scope(sec);
+        for (std::size_t first = 0; first < count; first += block) {
+            const auto n = std::min(block, count - first);
+            view_type views[block] = {};
+            std::uint64_t hashes[block] = {};
+            std::uint32_t short_hashes[block] = {};
+            unsigned int slots[block] = {};
+            typename layout_type::entry_type entries[block] = {};
+
+            for (std::size_t i = 0; i < n; ++i) {
+                views[i] = view_type(keys[first + i]);
+                auto f = fnv1a(views[i].data(), views[i].data() + views[i].size());
+                hashes[i] = mix(f ^ scope, 0);
+                short_hashes[i] = static_cast<std::uint32_t>(scope == 0 ? hashes[i] : mix(f, 0));
+                prefetch(l.seeds + reduce(hashes[i] >> 32, l.bucket_count));
+            }
+            for (std::size_t i = 0; i < n; ++i) {
+                auto d = l.seeds[reduce(hashes[i] >> 32, l.bucket_count)];
+                slots[i] = reduce(mix(hashes[i], d), l.index_size);
+                prefetch(l.index + slots[i]);
+            }
+            for (std::size_t i = 0; i < n; ++i) {
+                entries[i] = l.index[slots[i]];
+                if (entries[i] != layout_type::index_empty)
+                    prefetch(l.kvps + (entries[i] & ~layout_type::index_global));
+            }
+            for (std::size_t i = 0; i < n; ++i) {
+                auto e = entries[i];
+                visit(first + i, e != layout_type::index_empty &&
+                    l.entry_matches(e, sec, views[i], short_hashes[i]) ? e & ~layout_type::index_global : no_kvp);
+            }
+        }
+    } else if constexpr (layout_type::use_sorted) {
+        find_many_sorted(l, sec, keys, count, visit);
+    } else {
+        unsigned int first = 0;
+        unsigned int last = l.kvp_count;
+        if (sec != nullptr) {
+            auto run = l.find_section(*sec);
+            first = run != nullptr ? run->index : 0;
+            last = run != nullptr ? first + run->count : 0;
+        }
+        for (std::size_t i = 0; i < count; ++i) {
+            auto key = view_type(keys[i]);
+            auto h = key_hash(key.data(), key.data() + key.size());
+            auto k = first;
+            while (k < last && (l.kvps[k].key_hash != h || !equal_views(l.entry_key(k), key)))
+                ++k;
+            visit(i, k < last ? k : no_kvp);
+        }
+    }
+}
+
+// Precompiled configs are stored as a blob: a header, then the kvp table,
+// section directory, lookup index, seeds, value cache, and kvp buffer.
+// Offsets and index entries are always 32 bits wide. Each array starts on
+// an 8-byte boundary at a byte position recorded in the header, so a blob
+// can be mapped at any address and used in place. Numbers are stored in
+// the writing machine's byte order.
+constexpr std::uint32_t blob_magic = 0x42494E49; // "INIB" when read little-endian
+constexpr std::uint16_t blob_version = 2;
+
+struct blob_header {
+    std::uint32_t magic = blob_magic;
+    std::uint16_t version = blob_version;
+    std::uint8_t char_size = 0;
+    std::uint8_t index_kind = 0; // See blob_index_kind()
+    std::uint32_t kvp_count = 0;
+    std::uint32_t section_count = 0;
+    std::uint32_t index_size = 0;
+    std::uint32_t bucket_count = 0;
+    std::uint32_t chars = 0;     // Chars in the kvp buffer
+    std::uint32_t kvps_at = 0;   // Byte positions of the arrays
+    std::uint32_t sections_at = 0;
+    std::uint32_t index_at = 0;
+    std::uint32_t seeds_at = 0;
+    std::uint32_t cache_at = 0;
+    std::uint32_t buffer_at = 0;
+    std::uint32_t reserved = 0;
+    std::uint64_t size = 0;      // Bytes in the blob
+};
+
+// A value cache entry: the value pre-scanned as an integer, and converted
+// to a double and a bool, as the value_cache option stores them
+struct blob_number {
+    std::uint64_t magnitude = 0;
+    std::uint64_t real = 0;     // The double's bits (see double_bits())
+    std::uint8_t int_flags = 0; // integer_scan's negative, overflow, digits,
+                                // and complete, from the lowest bit up
+    std::uint8_t real_status = 0;
+    std::uint8_t boolean = 0;
+    std::uint8_t bool_status = 0;
+    std::uint32_t reserved = 0;
+};
+
+static_assert(sizeof(blob_header) == 64 && sizeof(blob_number) == 24 &&
+    sizeof(kvp_offsets<std::uint32_t>) == 24 && sizeof(section_entry<std::uint32_t>) == 12,
+    "Blob arrays must not contain padding");
+
+template<typename layout_type>
+constexpr std::uint8_t blob_index_kind() noexcept {
+    return layout_type::use_hash ? 0 : layout_type::use_sorted ? 1 : 2;
+}
+
+// Lays out a blob holding the given counts of each array
+template<typename char_type>
+constexpr blob_header plan_blob(unsigned int kvps, unsigned int sections, unsigned int index_size,
+    unsigned int buckets, unsigned int chars) noexcept
+{
+    std::uint64_t size = sizeof(blob_header);
+    auto add = [&size](std::uint64_t bytes) {
+        auto at = size;
+        size = (size + bytes + 7) / 8 * 8;
+        return static_cast<std::uint32_t>(at);
+    };
+
+    blob_header h;
+    h.char_size = sizeof(char_type);
+    h.kvp_count = kvps;
+    h.section_count = sections;
+    h.index_size = index_size;
+    h.bucket_count = buckets;
+    h.chars = chars;
+    h.kvps_at = add(std::uint64_t(kvps) * sizeof(kvp_offsets<std::uint32_t>));
+    h.sections_at = add(std::uint64_t(sections) * sizeof(section_entry<std::uint32_t>));
+    h.index_at = add(std::uint64_t(index_size) * sizeof(std::uint32_t));
+    h.seeds_at = add(std::uint64_t(buckets) * sizeof(std::uint16_t));
+    h.cache_at = add(std::uint64_t(kvps) * sizeof(blob_number));
+    h.buffer_at = add(std::uint64_t(chars) * sizeof(char_type));
+    h.size = size;
+    return h;
+}
+
+// The IEEE 754 bits of a finite or infinite double, without std::bit_cast
+// (which GCC 10 lacks). A zero's sign cannot be read at compile-time, so
+// 'negative' gives the sign.
+constexpr std::uint64_t double_bits(double x, bool negative) noexcept {
+    const auto sign = negative ? std::uint64_t(1) << 63 : 0;
+    auto m = x < 0 ? -x : x;
+    if (m == 0)
+        return sign;
+    if (m > std::numeric_limits<double>::max())
+        return sign | 0x7FF0000000000000;
+
+    // Scale into [1, 2), or below 1 for a subnormal; scaling by powers of
+    // two is exact
+    int exponent = 0;
+    for (; m >= 0x1p64; m *= 0x1p-64)
+        exponent += 64;
+    for (; m >= 2; m *= 0.5)
+        ++exponent;
+    for (; m < 0x1p-64 && exponent >= -1022 + 64; m *= 0x1p64)
+        exponent -= 64;
+    for (; m < 1 && exponent > -1022; m *= 2)
+        --exponent;
+
+    auto fraction = static_cast<std::uint64_t>(m * 0x1p52);
+    if (m < 1)
+        return sign | fraction;
+    return sign | std::uint64_t(exponent + 1023) << 52 | (fraction & 0xFFFFFFFFFFFFF);
+}
+// The double of the given IEEE 754 bits, as double_bits() gave them
+constexpr double bits_double(std::uint64_t bits) noexcept {
+    if (!std::is_constant_evaluated()) {
+        double x = 0;
+        std::memcpy(&x, &bits, sizeof(x));
+        return x;
+    }
+
+    const auto biased = static_cast<int>(bits >> 52 & 0x7FF);
+    const auto fraction = bits & 0xFFFFFFFFFFFFF;
+    double m = 0;
+    if (biased == 0x7FF) {
+        m = fraction == 0 ? std::numeric_limits<double>::infinity() : std::numeric_limits<double>::quiet_NaN();
+    } else {
+        m = static_cast<double>(biased != 0 ? fraction | std::uint64_t(1) << 52 : fraction);
+        for (auto exponent = std::max(biased, 1) - 1075; exponent != 0;) {
+            auto step = std::clamp(exponent, -60, 60);
+            m = step > 0 ? m * static_cast<double>(std::uint64_t(1) << step)
+                         : m / static_cast<double>(std::uint64_t(1) << -step);
+            exponent -= step;
+        }
+    }
+    return bits >> 63 != 0 ? -m : m;
+}
+
+template<typename char_type>
+constexpr blob_number pack_number(const char_type *value, const char_type *last) noexcept {
+    auto scan = scan_integer(value, last);
+    auto real = to_number<double>(value, last);
+    auto boolean = to_number<bool>(value, last);
+    // to_number() negates any number with digits, including a zero
+    auto real_scan = scan_float(value, last);
+
+    blob_number n;
+    n.magnitude = scan.magnitude;
+    n.real = double_bits(real.value, real.value < 0 || (real.value == 0 && real_scan.digits && real_scan.negative));
+    n.int_flags = static_cast<std::uint8_t>(scan.negative | scan.overflow << 1 |
+        scan.digits << 2 | scan.complete << 3);
+    n.real_status = static_cast<std::uint8_t>(real.status);
+    n.boolean = boolean.value;
+    n.bool_status = static_cast<std::uint8_t>(boolean.status);
+    return n;
+}
+// Converts a cached value as to_number<T>() would convert its string
+template<typename T>
+constexpr number<T> unpack_number(const blob_number& n) noexcept {
+    if constexpr (std::same_as<T, bool>) {
+        return { n.boolean != 0, static_cast<number_status>(n.bool_status) };
+    } else if constexpr (std::integral<T>) {
+        return to_integer<T>(integer_scan{ n.magnitude, (n.int_flags & 1) != 0,
+            (n.int_flags & 2) != 0, (n.int_flags & 4) != 0, (n.int_flags & 8) != 0 });
+    } else {
+        return narrow<T>(number<double>{ bits_double(n.real), static_cast<number_status>(n.real_status) });
+    }
+}
+
+// Stores an integer's bytes at the given position, in the machine's byte
+// order. The blob's structs are stored field by field, as they hold no
+// padding.
+template<std::integral T>
+constexpr void put_blob(unsigned char *out, std::size_t at, T value) noexcept {
+    auto bits = static_cast<std::make_unsigned_t<T>>(value);
+    for (std::size_t i = 0; i < sizeof(T); ++i) {
+        auto byte = std::endian::native == std::endian::little ? i : sizeof(T) - 1 - i;
+        out[at + byte] = static_cast<unsigned char>(bits >> (8 * i));
+    }
+}
+template<typename... Fields>
+constexpr void put_blob_fields(unsigned char *out, std::size_t at, Fields... fields) noexcept {
+    ((put_blob(out, at, fields), at += sizeof(fields)), ...);
+}
+constexpr void put_blob(unsigned char *out, std::size_t at, const blob_header& h) noexcept {
+    put_blob_fields(out, at, h.magic, h.version, h.char_size, h.index_kind, h.kvp_count,
+        h.section_count, h.index_size, h.bucket_count, h.chars, h.kvps_at, h.sections_at,
+        h.index_at, h.seeds_at, h.cache_at, h.buffer_at, h.reserved, h.size);
+}
+constexpr void put_blob(unsigned char *out, std::size_t at, const blob_number& n) noexcept {
+    put_blob_fields(out, at, n.magnitude, n.real, n.int_flags, n.real_status, n.boolean,
+        n.bool_status, n.reserved);
+}
+constexpr void put_blob(unsigned char *out, std::size_t at, const kvp_offsets<std::uint32_t>& k) noexcept {
+    put_blob_fields(out, at, k.key, k.key_size, k.value, k.value_size, k.section, k.key_hash);
+}
+constexpr void put_blob(unsigned char *out, std::size_t at, const section_entry<std::uint32_t>& s) noexcept {
+    put_blob_fields(out, at, s.name, s.count, s.index);
+}
+
+// Writes a config's layout into a zeroed blob planned by plan_blob(),
+// which may have reserved more room than the layout uses. Narrow offsets
+// and index entries are widened, and every value is converted for the
+// value cache.
+template<typename layout_type>
+constexpr void write_blob(const layout_type& l, blob_header h, unsigned char *out) noexcept {
+    using char_type = typename layout_type::view_type::value_type;
+    using entry_type = typename layout_type::entry_type;
+    using offset_type = decltype(l.kvps->key);
+    using wide_kvp = kvp_offsets<std::uint32_t>;
+    using wide_section = section_entry<std::uint32_t>;
+    auto widen = [](offset_type o) {
+        return o != npos<offset_type> ? std::uint32_t(o) : npos<std::uint32_t>;
+    };
+
+    h.index_kind = blob_index_kind<layout_type>();
+    h.section_count = l.section_count;
+    h.index_size = l.index_size;
+    h.bucket_count = l.bucket_count;
+    h.chars = l.buffer_size();
+    put_blob(out, 0, h);
+
+    for (unsigned int i = 0; i < l.kvp_count; ++i) {
+        const auto& k = l.kvps[i];
+        put_blob(out, h.kvps_at + i * sizeof(wide_kvp),
+            wide_kvp{ k.key, k.key_size, k.value, k.value_size, widen(k.section), k.key_hash });
+        put_blob(out, h.cache_at + i * sizeof(blob_number),
+            pack_number(l.buffer + k.value, l.buffer + k.value + k.value_size));
+    }
+    for (unsigned int i = 0; i < l.section_count; ++i) {
+        const auto& s = l.sections[i];
+        put_blob(out, h.sections_at + i * sizeof(wide_section), wide_section{ s.name, s.count, s.index });
+    }
+    for (unsigned int i = 0; i < l.index_size; ++i) {
+        entry_type e = l.index[i];
+        std::uint32_t wide = ~std::uint32_t(0);
+        if (e != layout_type::index_empty) {
+            wide = (e & ~layout_type::index_global) |
+                ((e & layout_type::index_global) ? 0x80000000u : 0u);
+        }
+        put_blob(out, h.index_at + i * sizeof(std::uint32_t), wide);
+    }
+    for (unsigned int i = 0; i < l.bucket_count; ++i)
+        put_blob(out, h.seeds_at + i * sizeof(std::uint16_t), l.seeds[i]);
+    for (unsigned int i = 0; i < h.chars; ++i)
+        put_blob(out, h.buffer_at + i * sizeof(char_type), l.buffer[i]);
+}
+
+// Keeps a counter on its own cache line, so that threads counting different
+// keys do not contend for it
+struct alignas(64) padded_counter {
+    std::atomic<std::uint64_t> count{0};
+};
+
+// A miss counter for one query hash (0 while the slot is unclaimed)
+struct alignas(64) miss_counter {
+    std::atomic<std::uint64_t> hash{0};
+    std::atomic<std::uint64_t> count{0};
+};
+
+// Durations of the phases of a run-time parse, in nanoseconds. Phases that
+// run on several threads are timed from start to finish.
+struct parse_times {
+    std::uint64_t split = 0;  // Splitting the text into blocks
+    std::uint64_t verify = 0; // verify_and_size(), or tokenizing changed blocks on a reload
+    std::uint64_t fill = 0;   // fill_kvp_buffer() and block records, or copying on a reload
+    std::uint64_t index = 0;  // Building the lookup index
+};
+
+// Appends text to a JSON string, as UTF-8 with quotes and controls escaped
+template<typename char_type>
+void append_json(std::string& out, std::basic_string_view<char_type> text) {
+    out += '"';
+    transcode_chars<char>(text.data(), text.data() + text.size(), [&out](char c) {
+        if (c == '"' || c == '\\') {
+            out += '\\';
+            out += c;
+        } else if (static_cast<unsigned char>(c) < 0x20) {
+            constexpr char digits[] = "0123456789abcdef";
+            out += "\\u00";
+            out += digits[(c >> 4) & 0xF];
+            out += digits[c & 0xF];
+        } else {
+            out += c;
+        }
+    });
+    out += '"';
+}
+
+// Counts the run-time lookups of a config, as kept by the lookup_stats
+// option: hits per kvp, misses per query hash, and a histogram of lookup
+// latencies. Counting is thread-safe and lock-free; a lookup touches only
+// its own key's counter and one latency bucket.
+class lookup_recorder {
+public:
+    // Misses are counted for this many distinct query hashes, with the rest
+    // counted together
+    constexpr static unsigned int miss_slots = 64;
+    // Latency bucket b counts lookups taking less than 2^b nanoseconds (and
+    // at least 2^(b-1)), with the last bucket also counting any slower
+    constexpr static unsigned int latency_buckets = 32;
+
+private:
+    std::unique_ptr<padded_counter[]> m_owned_hits;
+    padded_counter *m_hits = nullptr;
+    unsigned int m_kvp_count = 0;
+    miss_counter m_misses[miss_slots];
+    padded_counter m_other_misses;
+    padded_counter m_latency[latency_buckets];
+
+    void count_miss(std::uint64_t hash) noexcept {
+        hash += hash == 0; // 0 marks an unclaimed slot
+        constexpr unsigned int max_probes = 8;
+        for (unsigned int p = 0; p < max_probes; ++p) {
+            auto& slot = m_misses[(hash + p) % miss_slots];
+            auto seen = slot.hash.load(std::memory_order_relaxed);
+            if (seen == 0 && slot.hash.compare_exchange_strong(seen, hash, std::memory_order_relaxed))
+                seen = hash;
+            if (seen == hash) {
+                slot.count.fetch_add(1, std::memory_order_relaxed);
+                return;
+            }
+        }
+        m_other_misses.count.fetch_add(1, std::memory_order_relaxed);
+    }
+
+public:
+    explicit lookup_recorder(unsigned int kvp_count)
+        : m_owned_hits(std::make_unique<padded_counter[]>(kvp_count)),
+          m_hits(m_owned_hits.get()), m_kvp_count(kvp_count) {}
+    // Counts hits in the given counters instead, without allocating
+    constexpr explicit lookup_recorder(std::span<padded_counter> hits) noexcept
+        : m_hits(hits.data()), m_kvp_count(static_cast<unsigned int>(hits.size())) {}
+
+    // Records a lookup that found kvp 'i' (or missed if it is npos), whose
+    // query had the given hash, and that took 'ns' nanoseconds
+    void record(unsigned int i, std::uint64_t hash, std::uint64_t ns) noexcept {
+        if (i < m_kvp_count)
+            m_hits[i].count.fetch_add(1, std::memory_order_relaxed);
+        else
+            count_miss(hash);
+        if (ns != npos<std::uint64_t>) {
+            auto b = std::min<unsigned int>(static_cast<unsigned int>(std::bit_width(ns)), latency_buckets - 1);
+            m_latency[b].count.fetch_add(1, std::memory_order_relaxed);
+        }
+    }
+
+    std::uint64_t hits(unsigned int i) const noexcept {
+        return m_hits[i].count.load(std::memory_order_relaxed);
+    }
+
+    // Writes the counts as JSON, naming each key that was hit from the
+    // given layout (with a null section above the first section header), and
+    // including 'parse' if it is not nullptr. The profile lists the keys that
+    // were hit, hottest first, as the profile option takes them:
+    //   { "hits": [ { "section": "Cat", "key": "lives", "count": 3 }, ... ],
+    //     "profile": [ "[Cat]lives", ... ],
+    //     "misses": [ { "hash": "0x...", "count": 1 }, ... ], "other_misses": 0,
+    //     "latency_ns": [ { "below": 32, "count": 4 }, ... ],
+    //     "parse_ns": { "split": 0, "verify": 0, "fill": 0, "index": 0 } }
+    // Only nonzero counts are listed.
+    template<typename layout_type>
+    std::string json(const layout_type& l, const parse_times *parse = nullptr) const {
+        using offset_type = decltype(l.kvps->key);
+        using view_type = typename layout_type::view_type;
+        constexpr auto relaxed = std::memory_order_relaxed;
+        auto number = [](std::uint64_t n) {
+            return std::to_string(n);
+        };
+
+        std::string out = "{\"hits\":[";
+        const char *comma = "";
+        for (unsigned int i = 0; i < m_kvp_count && i < l.kvp_count; ++i) {
+            auto n = hits(i);
+            if (n == 0)
+                continue;
+            const auto& k = l.kvps[i];
+            out += comma;
+            out += "{\"section\":";
+            if (k.section != npos<offset_type>)
+                append_json(out, view_type(l.buffer + k.section));
+            else
+                out += "null";
+            out += ",\"key\":";
+            append_json(out, view_type(l.buffer + k.key, k.key_size));
+            out += ",\"count\":" + number(n) + "}";
+            comma = ",";
+        }
+
+        std::vector<std::pair<std::uint64_t, unsigned int>> hot;
+        for (unsigned int i = 0; i < m_kvp_count && i < l.kvp_count; ++i) {
+            if (auto n = hits(i); n > 0)
+                hot.emplace_back(n, i);
+        }
+        std::stable_sort(hot.begin(), hot.end(), [](auto a, auto b) { return a.first > b.first; });
+        out += "],\"profile\":[";
+        comma = "";
+        for (auto [n, i] : hot) {
+            const auto& k = l.kvps[i];
+            std::basic_string<typename view_type::value_type> name;
+            if (k.section != npos<offset_type>)
+                name.append(1, '[').append(view_type(l.buffer + k.section)).append(1, ']');
+            name.append(view_type(l.buffer + k.key, k.key_size));
+            out += comma;
+            append_json(out, view_type(name));
+            comma = ",";
+        }
+
+        out += "],\"misses\":[";
+        comma = "";
+        for (const auto& m : m_misses) {
+            auto n = m.count.load(relaxed);
+            if (n == 0)
+                continue;
+            constexpr char digits[] = "0123456789abcdef";
+            char hex[17] = {};
+            for (int d = 0; d < 16; ++d)
+                hex[d] = digits[(m.hash.load(relaxed) >> (60 - 4 * d)) & 0xF];
+            out += comma;
+            out += std::string("{\"hash\":\"0x") + hex + "\",\"count\":" + number(n) + "}";
+            comma = ",";
+        }
+        out += "],\"other_misses\":" + number(m_other_misses.count.load(relaxed));
+
+        out += ",\"latency_ns\":[";
+        comma = "";
+        for (unsigned int b = 0; b < latency_buckets; ++b) {
+            auto n = m_latency[b].count.load(relaxed);
+            if (n == 0)
+                continue;
+            out += comma;
+            out += "{\"below\":" + number(std::uint64_t(1) << b) + ",\"count\":" + number(n) + "}";
+            comma = ",";
+        }
+        out += "]";
+
+        if (parse != nullptr) {
+            out += ",\"parse_ns\":{\"split\":" + number(parse->split) + ",\"verify\":" + number(parse->verify) +
+                ",\"fill\":" + number(parse->fill) + ",\"index\":" + number(parse->index) + "}";
+        }
+        return out + "}";
+    }
+};
+
+// Looks up a key through find(sec, key), which returns a kvp table position
+// or ~0u, recording the lookup if 'stats' is not nullptr. Misses are
+// recorded by the query's index hash.
+template<typename char_type, typename FindFn>
+unsigned int recorded_find(lookup_recorder *stats, const std::basic_string_view<char_type> *sec,
+    const basic_key<char_type>& key, FindFn&& find) noexcept
+{
+    if (stats == nullptr)
+        return find(sec, key);
+    auto start = std::chrono::steady_clock::now();
+    auto i = find(sec, key);
+    auto ns = std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now() - start).count();
+    stats->record(i, i == ~0u ? key.hash(hash_scope(sec)) : 0, static_cast<std::uint64_t>(ns));
+    return i;
+}
+// Checks that a tryget_many() batch has room for every key's value
+inline void check_batch(std::size_t keys, std::size_t values) {
+    if (values < keys)
+        throw std::length_error("tryget_many() was given fewer values than keys!");
+}
+
+// Records one key of a tryget_many() batch, whose lookups are not timed
+template<typename char_type>
+void record_batched(lookup_recorder& stats, const std::basic_string_view<char_type> *sec,
+    std::basic_string_view<char_type> key, unsigned int i) noexcept
+{
+    stats.record(i, i == ~0u ? basic_key<char_type>(key).hash(hash_scope(sec)) : 0, npos<std::uint64_t>);
+}
+
+} // namespace detail
+
+/**
+ * A key for run-time lookups, hashed once when made. Lookups that are given
+ * a key made ahead of time (a constexpr key, or the _key literal) skip
+ * hashing and measuring it; any lookup checks the key's hash and length
+ * before comparing chars. Every run-time lookup accepts a key in place of
+ * a string, and makes one from a string if given that instead.
+ * A key refers to its string, which must outlive it.
+ */
+template<typename CharT>
+class basic_key
+{
+public:
+    using char_type = CharT;
+    using view_type = std::basic_string_view<char_type>;
+
+private:
+    view_type m_name;
+    std::uint64_t m_fnv = 0;  // detail::fnv1a() of the name
+    std::uint64_t m_hash = 0; // detail::hash() of the name
+
+public:
+    constexpr basic_key(const char_type *name) noexcept
+        : basic_key(view_type(name)) {}
+    constexpr basic_key(view_type name) noexcept
+        : m_name(name),
+          m_fnv(detail::fnv1a(name.data(), name.data() + name.size())),
+          m_hash(detail::mix(m_fnv, 0)) {}
+    template<typename Alloc>
+    constexpr basic_key(const std::basic_string<char_type, std::char_traits<char_type>, Alloc>& name) noexcept
+        : basic_key(view_type(name)) {}
+
+    constexpr view_type name() const noexcept {
+        return m_name;
+    }
+    /**
+     * Returns the lookup index's hash of the key, for tryget(key), or for
+     * the section with the given scope (see detail::scope_hash()).
+     */
+    constexpr std::uint64_t hash(std::uint64_t scope = 0) const noexcept {
+        return scope == 0 ? m_hash : detail::mix(m_fnv ^ scope, 0);
+    }
+    /**
+     * Returns the short hash that kvps keep of their keys.
+     */
+    constexpr std::uint32_t short_hash() const noexcept {
+        return static_cast<std::uint32_t>(m_hash);
+    }
+};
+
+using key = basic_key<char>;
+
+/**
+ * Converts text between char types, where char holds UTF-8 and wider chars
+ * hold UTF-16 or UTF-32 by their size. Invalid sequences become U+FFFD.
+ */
+template<typename To, typename From>
+constexpr std::basic_string<To> transcode(std::basic_string_view<From> text) {
+    std::basic_string<To> out;
+    out.reserve(text.size());
+    detail::transcode_chars<To>(text.data(), text.data() + text.size(), [&out](To c) { out.push_back(c); });
+    return out;
+}
+template<typename To, typename From>
+constexpr std::basic_string<To> transcode(const From *text) {
+    return transcode<To>(std::basic_string_view<From>(text));
+}
+
+/**
+ * Binds the key Name to a member of an aggregate, for ini_config::bind().
+ * Made with field<Name>(&Class::member).
+ */
+template<string_container Name, typename Class, typename T>
+struct field_binding {
+    T Class::*member;
+};
+template<string_container Name, typename Class, typename T>
+consteval auto field(T Class::*member) noexcept {
+    return field_binding<Name, Class, T>{ member };
+}
 
-#include <concepts> // std::integral, std::floating_point
-#include <compare> // std::strong_ordering
+/**
+ * Describes how ini_config::bind() fills an aggregate: 'fields' is a tuple
+ * of field()s. By default this is the aggregate's static ini_fields member;
+ * specialize binding for aggregates that cannot be given one:
+ *
+ *   template<> struct ini_config::binding<CatSettings> {
+ *       constexpr static auto fields = std::tuple(
+ *           field<"lives">(&CatSettings::lives),
+ *           field<"color">(&CatSettings::color));
+ *   };
+ */
+template<typename T>
+struct binding {
+    constexpr static auto fields = T::ini_fields;
+};
 
-namespace ini_config {
+namespace detail {
+// The kvps that a config type's iterators point to. Every instance of a
+// config type holds the same text, so one table, built from a static
+// instance, serves them all.
+template<typename Config>
+struct static_kvps {
+    constexpr static Config config{};
+    constexpr static auto list = config.make_kvp_list();
+};
+
+// The char type that an ini_config stores its text in (see utf8_storage)
+template<typename input_char_type, typename... Options>
+using stored_char_t = std::conditional_t<(sizeof(input_char_type) > 1 &&
+    (std::same_as<Options, utf8_storage> || ...)), char, input_char_type>;
+
+// A value found by a run-time lookup: its text, whose data() is nullptr if
+// the key is missing, and its kvp table position, for configs that convert
+// values without parsing them
+template<typename char_type>
+struct found_value {
+    std::basic_string_view<char_type> text;
+    unsigned int kvp = ~0u;
+
+    constexpr bool found() const noexcept {
+        return text.data() != nullptr;
+    }
+};
 
 /**
- * A minimal container for a given string literal, used to allow string
- * literals to be passed as template parameters.
+ * The run-time lookups shared by every config type. Config provides
+ * find_value(sec, key), returning a found_value for tryget(sec, key), or
+ * for tryget(key) if 'sec' is nullptr. It may also provide
+ * convert_value<T>(found), to convert without parsing (e.g. from a value
+ * cache), and many(sec, keys, values), to batch tryget_many().
+ * Values are null-terminated strings, or string_views if Terminated is
+ * false (for configs that use their text in place).
  */
-template<typename T = char, unsigned long int N = 0>
-struct string_container {
-    using char_type = T;
+template<typename Config, typename CharT, bool Terminated = true>
+class lookup_surface
+{
+    using char_type = CharT;
+    using view_type = std::basic_string_view<char_type>;
+    using value_type = std::conditional_t<Terminated, const char_type *, view_type>;
 
-    char_type data[N];
-    consteval string_container(const char_type (&s)[N]) noexcept {
-        auto dst = data;
-        for (auto src = s; src != s + N; ++src)
-            *dst++ = *src;
+    constexpr const Config& config() const noexcept {
+        return static_cast<const Config&>(*this);
     }
-    consteval operator const char_type *() const noexcept {
-        return data;
-    }
-    consteval auto size() const noexcept {
-        return N;
+    constexpr value_type value(const found_value<char_type>& v) const noexcept {
+        if constexpr (Terminated)
+            return v.found() ? v.text.data() : empty_string<char_type>;
+        else
+            return v.text;
     }
-    consteval auto begin() const noexcept {
-        return data;
+    template<typename T>
+    constexpr number<T> convert(const found_value<char_type>& v) const noexcept {
+        return config().template convert_value<T>(v);
     }
-    consteval auto end() const noexcept {
-        return data + N;
+
+protected:
+    // Converts a value by parsing its text; missing keys convert to zero
+    template<typename T>
+    constexpr static number<T> convert_value(const found_value<char_type>& v) noexcept {
+        if (!v.found())
+            return {};
+        return to_number<T>(v.text.data(), v.text.data() + v.text.size());
     }
-};
 
-template<auto Input>
-class ini_config
-{
-    // Private implementation stuff must be defined first.
-    // Jump to the public section below for the available interface.
+    // Looks up each key of a batch in turn
+    std::size_t many(const view_type *sec, std::span<const value_type> keys,
+        std::span<value_type> values) const
+    {
+        check_batch(keys.size(), values.size());
+        std::size_t found = 0;
+        for (std::size_t i = 0; i < keys.size(); ++i) {
+            auto v = config().find_value(sec, keys[i]);
+            if constexpr (Terminated)
+                values[i] = v.text.data();
+            else
+                values[i] = v.text;
+            found += v.found();
+        }
+        return found;
+    }
 
-    using char_type = typename decltype(Input)::char_type;
+public:
+    /**
+     * tryget() calls are for run-time use when 'sec' or 'key'
+     * is not known at compile-time.
+     * Lookups go through the index selected by the config's options,
+     * which is a perfect hash by default. 'sec' and 'key' may be given as
+     * string_views (or std::strings), which need not be null-terminated.
+     * Missing keys give an empty string (or view), and zero from typed
+     * lookups.
+     */
+    value_type tryget(const basic_key<char_type>& key) const noexcept {
+        return value(config().find_value(nullptr, key));
+    }
+    template<typename T> requires(std::integral<T> || std::floating_point<T>)
+    T tryget(const basic_key<char_type>& key) const noexcept {
+        return convert<T>(config().find_value(nullptr, key)).value;
+    }
+    value_type tryget(view_type sec, const basic_key<char_type>& key) const noexcept {
+        return value(config().find_value(&sec, key));
+    }
+    template<typename T> requires(std::integral<T> || std::floating_point<T>)
+    T tryget(view_type sec, const basic_key<char_type>& key) const noexcept {
+        return convert<T>(config().find_value(&sec, key)).value;
+    }
 
-    consteval static bool isgraph(char_type c) noexcept {
-        return c > ' ' && c != 0x7F;
+    /**
+     * Returns the value for the given key as a string_view, sized from the
+     * stored value length so that it need not be measured.
+     * Returns an empty view if the key does not exist.
+     */
+    view_type tryget_view(const basic_key<char_type>& key) const noexcept {
+        return config().find_value(nullptr, key).text;
+    }
+    view_type tryget_view(view_type sec, const basic_key<char_type>& key) const noexcept {
+        return config().find_value(&sec, key).text;
     }
-    consteval static bool iseol(char_type c) noexcept {
-        return c == '\n' || c == '\0';
+
+    /**
+     * Looks up a batch of keys, storing each one's value in the matching
+     * element of 'values' (nullptr, or an empty view, if the key does not
+     * exist). Configs with a lookup index resolve the section once for the
+     * whole batch, and overlap the memory accesses of hash lookups.
+     * Returns the number of keys found. Throws std::length_error if
+     * 'values' is shorter than 'keys'.
+     */
+    std::size_t tryget_many(std::span<const value_type> keys, std::span<value_type> values) const {
+        return config().many(nullptr, keys, values);
     }
-    consteval static bool iscomment(char_type c) noexcept {
-        return c == ';' || c == '#';
+    std::size_t tryget_many(view_type sec, std::span<const value_type> keys,
+        std::span<value_type> values) const
+    {
+        return config().many(&sec, keys, values);
     }
 
-    constexpr static bool stringmatch(const char_type *a, const char_type *b) noexcept {
-        while (*a == *b && (*a != '\0' || *b != '\0'))
-            ++a, ++b;
-        return *a == *b && *a == '\0';
+    bool trycontains(const basic_key<char_type>& key) const noexcept {
+        return config().find_value(nullptr, key).found();
     }
-    consteval static const char_type *nextline(const char_type *in) noexcept {
-        while (!iseol(*in))
-            ++in;
-        return in + 1;
+    bool trycontains(view_type sec, const basic_key<char_type>& key) const noexcept {
+        return config().find_value(&sec, key).found();
     }
 
-    template<std::integral int_type>
-    constexpr static int_type from_string(const char_type *str) noexcept {
-        int_type ret = 0;
-        bool neg = *str == '-';
-        if (neg)
-            ++str;
-        for (; *str && *str >= '0' && *str <= '9'; ++str)
-            ret = ret * 10 + (*str - '0');
-        return !neg ? ret : -ret;
-    }
-    template<std::floating_point float_type>
-    constexpr static float_type from_string(const char_type *str) noexcept {
-        float_type ret = 0;
-        bool neg = *str == '-';
-        if (neg)
-            ++str;
-        for (; *str && *str >= '0' && *str <= '9'; ++str)
-            ret = ret * 10 + (*str - '0');
-        if (*str == '.') {
-            float_type dec = 0.1;
-            for (++str; *str && *str >= '0' && *str <= '9'; ++str) {
-                ret += (*str - '0') * dec;
-                dec /= 10;
-            }
-        }
-        return !neg ? ret : -ret;
+    /**
+     * Checks if the given key exists and its entire value converts to the
+     * given type (e.g. "9" is an int, "4.5" is a double, "yes" is a bool).
+     */
+    template<typename T> requires(std::integral<T> || std::floating_point<T>)
+    bool trycontains(const basic_key<char_type>& key) const noexcept {
+        return convert<T>(config().find_value(nullptr, key)).status == number_status::ok;
+    }
+    template<typename T> requires(std::integral<T> || std::floating_point<T>)
+    bool trycontains(view_type sec, const basic_key<char_type>& key) const noexcept {
+        return convert<T>(config().find_value(&sec, key)).status == number_status::ok;
     }
 
-    // Validates INI syntax, returning the count of chars
-    // needed to store all section names, keys, and values
-    consteval static unsigned int verify_and_size() {
-        unsigned int sizechars = 0;
+    /**
+     * Converts the value of the given key to the given type, or returns why
+     * it could not: the key is missing, the value is not entirely a number
+     * of that type, or the number does not fit in it.
+     */
+    template<typename T> requires(std::integral<T> || std::floating_point<T>)
+    conversion_result<T> tryconvert(const basic_key<char_type>& key) const noexcept {
+        auto v = config().find_value(nullptr, key);
+        return make_result(v.found(), convert<T>(v));
+    }
+    template<typename T> requires(std::integral<T> || std::floating_point<T>)
+    conversion_result<T> tryconvert(view_type sec, const basic_key<char_type>& key) const noexcept {
+        auto v = config().find_value(&sec, key);
+        return make_result(v.found(), convert<T>(v));
+    }
+};
+} // namespace detail
 
-        auto line = Input.begin();
-        do {
-            auto p = line;
-            // Remove beginning whitespace
-            for (; !iseol(*p) && !isgraph(*p); ++p);
+template<auto Input, typename... Options>
+class ini_config
+    : public detail::lookup_surface<ini_config<Input, Options...>,
+        detail::stored_char_t<typename decltype(Input)::char_type, Options...>>
+{
+    // Private implementation stuff must be defined first.
+    // Jump to the public section below for the available interface.
 
-            if (iseol(*p) || iscomment(*p))
-                continue;
+    // The text as stored, which is Input transcoded to UTF-8 if chosen by
+    // the utf8_storage option
+    using input_char_type = typename decltype(Input)::char_type;
+    using lookups = detail::lookup_surface<ini_config, detail::stored_char_t<input_char_type, Options...>>;
+    friend lookups;
+    constexpr static bool use_utf8 = !std::same_as<detail::stored_char_t<input_char_type, Options...>,
+        input_char_type>;
+    constexpr static auto input = [] {
+        if constexpr (use_utf8)
+            return detail::to_utf8<Input>();
+        else
+            return Input;
+    }();
 
-            // Check for section header
-            if (*p == '[') {
-                do {
-                    ++sizechars;
-                    ++p;
-                } while (!iseol(*p) && *p != ']');
-                if (iseol(*p))
-                    throw "Bad section tag!";
-                ++sizechars; // Null terminator
-                continue;
-            }
+    using char_type = typename decltype(input)::char_type;
+    using view_type = std::basic_string_view<char_type>;
+    using input_view_type = std::basic_string_view<input_char_type>;
 
-            // This is the key (and whitespace until =)
-            for (bool keyend = false; !iseol(*p); ++p) {
-                if (*p == '=')
-                    break;
-                if (!keyend) {
-                    if (!isgraph(*p))
-                        keyend = true;
-                    else
-                        ++sizechars;
-                } else {                    
-                    if (isgraph(*p))
-                        throw "Invalid key!";
-                }   
-            }
-            if (*p != '=')
-                throw "Invalid key!";
-            ++p;
-
-            // Next is the value
-            auto oldsizechars = sizechars;
-            for (bool valuestart = false; !iseol(*p); ++p) {
-                if (!valuestart && isgraph(*p))
-                    valuestart = true;
-                if (valuestart)
-                    ++sizechars;
+    // The parts of the text to keep, as chosen from the Options pack
+    using section_filter = typename detail::find_option<detail::is_section_filter,
+        void, Options...>::type;
+    constexpr static bool drop_text = (std::same_as<Options, drop_number_text> || ...);
+    struct text_filter {
+        constexpr bool section(const char_type *first, const char_type *last) const noexcept {
+            if constexpr (std::is_void_v<section_filter>)
+                return true;
+            else
+                return section_filter::contains(first, last);
+        }
+        constexpr bool value(const char_type *first, const char_type *last) const noexcept {
+            if constexpr (drop_text) {
+                return detail::to_number<double>(first, last).status == detail::number_status::invalid &&
+                    !detail::scan_integer(first, last).complete;
+            } else {
+                return true;
             }
-            if (oldsizechars == sizechars)
-                throw "No value!";
+        }
+    };
 
-            // All good, add two bytes for key/value terminators
-            sizechars += 2;
-        } while ((line = nextline(line)) != Input.end());
-        
-        return sizechars;
+    // Validates INI syntax, returning the sizes needed to store all kept
+    // section names, keys, and values
+    consteval static detail::parse_sizes measure() {
+        auto sizes = detail::verify_and_size(input.begin(), input.end(), text_filter{});
+        switch (sizes.status) {
+        case detail::parse_status::bad_section:
+            throw "Bad section tag!";
+        case detail::parse_status::invalid_key:
+            throw "Invalid key!";
+        case detail::parse_status::no_value:
+            throw "No value!";
+        default:
+            return sizes;
+        }
     }
+    // The text is measured once per instantiation; everything sized by it
+    // reads this result instead of tokenizing again.
+    constexpr static detail::parse_sizes sizes = measure();
 
+    // Counts the chars needed to store all section names, keys, and values
+    consteval static unsigned int verify_and_size() noexcept {
+        return sizes.chars;
+    }
     // Counts how many key-value pairs are in the text
     consteval static unsigned int kvpcount() noexcept {
-        unsigned int count = 0;
-
-        auto line = Input.begin();
-        do {
-            auto p = line;
-            // Remove beginning whitespace
-            for (; !iseol(*p) && !isgraph(*p); ++p);
-
-            if (iseol(*p) || iscomment(*p) || *p == '[')
-                continue;
-
-            count++; // Must be a key-value pair
-        } while ((line = nextline(line)) != Input.end());
-        
-        return count;
+        return sizes.kvps;
+    }
+    // Counts how many section headers are in the text
+    consteval static unsigned int sectioncount() noexcept {
+        return sizes.sections;
     }
 
-    // A compact buffer for section names, keys, and values
+    // A compact buffer holding the key pool (section names and keys), then
+    // the value pool
     char_type kvp_buffer[verify_and_size() + 1] = {};
 
-    consteval void fill_kvp_buffer() noexcept {
-        auto bptr = kvp_buffer;
+    // Offsets into kvp_buffer are kept as narrow as its size allows
+    using offset_type = std::conditional_t<(verify_and_size() < 0xFFFF),
+        std::uint16_t, std::uint32_t>;
 
-        auto line = Input.begin();
-        do {
-            auto p = line;
-            // Remove beginning whitespace
-            for (; !iseol(*p) && !isgraph(*p); ++p);
+    // Locations of each key-value pair's strings within kvp_buffer
+    std::array<detail::kvp_offsets<offset_type>, kvpcount()> kvp_table = {};
 
-            if (iseol(*p) || iscomment(*p))
-                continue;
+    // The section directory, listing each section's first run of kvps in
+    // order of appearance (see begin(section)).
+    std::array<detail::section_entry<offset_type>, sectioncount()> section_table = {};
+    unsigned int section_count = 0;
 
-            if (*p == '[') {
-                do {
-                    *bptr++ = *p++;
-                } while (*p != ']');
-                *bptr++ = '\0';
-                continue;
-            }
+    // The lookup index, as chosen from the Options pack
+    using index_policy = typename detail::find_option<detail::is_index_policy,
+        perfect_hash_index, Options...>::type;
+    using index_entry = std::conditional_t<(kvpcount() < 0x7FFF),
+        std::uint16_t, std::uint32_t>;
+    using layout_type = detail::layout<char_type, offset_type, index_entry, index_policy>;
 
-            // This is the key (and whitespace until =)
-            for (bool keyend = false; !iseol(*p); ++p) {
-                if (*p == '=')
-                    break;
-                if (!keyend) {
-                    if (!isgraph(*p))
-                        keyend = true;
-                    else
-                        *bptr++ = *p;
-                } 
-            }
-            ++p;
-            *bptr++ = '\0';
-
-            // Next is the value
-            for (bool valuestart = false; !iseol(*p); ++p) {
-                if (!valuestart && isgraph(*p))
-                    valuestart = true;
-                if (valuestart)
-                    *bptr++ = *p;
-            }
-            *bptr++ = '\0';
-        } while ((line = nextline(line)) != Input.end());
-        *bptr = '\0';
-    }
+    // Hash slots or sorted entries, depending on index_policy
+    std::array<index_entry, detail::index_size<index_policy>(kvpcount())> index_table = {};
+    std::array<std::uint16_t, detail::index_buckets<index_policy>(kvpcount())> index_seeds = {};
+    unsigned int index_count = detail::index_size<index_policy>(kvpcount());
+    unsigned int seed_count = detail::index_buckets<index_policy>(kvpcount()); // Zero if sorted instead
 
-public:
-    // Stores a key-value pair, including a section identifier
-    struct kvp {
-        const char_type *section = nullptr;
-        const char_type *first = nullptr;
-        const char_type *second = nullptr;
-    };
+    // The optional value cache, holding every value pre-scanned as an
+    // integer (to be narrowed per type) and pre-converted to a double and
+    // a bool
+    constexpr static bool use_cache = (std::same_as<Options, value_cache> || ...);
+    std::array<detail::integer_scan, use_cache ? kvpcount() : 0> int_cache = {};
+    std::array<detail::number<double>, use_cache ? kvpcount() : 0> float_cache = {};
+    std::array<detail::number<bool>, use_cache ? kvpcount() : 0> bool_cache = {};
 
-    class iterator {
-        const char_type *m_pos = nullptr;
-        kvp m_current = {};
+    // The kvps named by the profile option, hottest first; entries of keys
+    // not in the config are found by neither lookup. Sorted and linear
+    // lookups check these before searching; hash lookups already take one
+    // probe, and only gain from the packed buffer.
+    using profile_type = typename detail::find_option<detail::is_profile, profile<>, Options...>::type;
+    constexpr static bool use_hot = profile_type::size > 0 && !layout_type::use_hash;
+    std::array<detail::hot_kvp<index_entry>, profile_type::size> hot_table = {};
 
-        constexpr const auto& get_next() noexcept {
-            if (*m_pos == '\0') {
-                // Set first to nullptr to indicate that we're at the end
-                m_current.first = nullptr;
-            } else {
-                // Enter new section(s) if necessary
-                while (*m_pos == '[') {
-                    m_current.section = m_pos + 1;
-                    while (*m_pos++ != '\0');
-                }
-                m_current.first = m_pos;
-                while (*m_pos++ != '\0');
-                m_current.second = m_pos;
-                while (*m_pos++ != '\0');
-            }
-            return m_current;
+    // The kvps that iterators point to (see detail::static_kvps)
+    template<typename> friend struct detail::static_kvps;
+    consteval auto make_kvp_list() const noexcept {
+        // Pointers are taken as &kvp_buffer[i] rather than kvp_buffer + i,
+        // which GCC 12 misreads as unterminated strings (-Wstringop-overread)
+        std::array<detail::kvp<char_type>, kvpcount()> list = {};
+        for (unsigned int i = 0; i < kvpcount(); ++i) {
+            const auto& k = kvp_table[i];
+            list[i] = { k.section != detail::npos<offset_type> ? &kvp_buffer[k.section] : nullptr,
+                &kvp_buffer[k.key], &kvp_buffer[k.value] };
         }
+        return list;
+    }
+    constexpr static const detail::kvp<char_type> *kvp_list() noexcept {
+        return detail::static_kvps<ini_config>::list.data();
+    }
 
-    public:
-        using difference_type = long int;
-        using value_type = kvp;
+    constexpr layout_type view() const noexcept {
+        return {
+            kvp_buffer,
+            kvp_table.data(), static_cast<unsigned int>(kvp_table.size()),
+            section_table.data(), section_count,
+            index_table.data(), index_count,
+            index_seeds.data(), seed_count
+        };
+    }
 
-        // 'pos' is a location within kvp_buffer
-        constexpr iterator(const char_type *pos) noexcept
-            : m_pos(pos)
-        {
-            while (*m_pos == '[') {
-                m_current.section = m_pos + 1;
-                while (*m_pos++ != '\0');
-            }
-            get_next();
+    consteval void fill_index() {
+        if constexpr (layout_type::use_hash) {
+            // Large enough for any of the builder's per-entry or per-bucket arrays
+            using scratch = detail::fixed_scratch<detail::index_capacity(kvpcount()) +
+                detail::index_buckets<index_policy>(kvpcount()) + 1>;
+            auto l = view();
+            detail::build_hash_or_sorted_index(l, index_table.data(), index_seeds.data(), scratch{});
+            index_count = l.index_size;
+            seed_count = l.bucket_count;
+        } else if constexpr (layout_type::use_sorted) {
+            index_count = detail::build_sorted_index(view(), index_table.data());
         }
-        constexpr iterator() = default;
+    }
+
+    // Resolves the profile's keys to kvps, and packs their strings at the
+    // front of the buffer
+    consteval void fill_hot() {
+        unsigned int hot[profile_type::size + 1] = {};
+        unsigned int hot_count = 0;
+        profile_type::template for_each<char_type>([&](view_type name) {
+            const view_type *sec = nullptr;
+            view_type s;
+            // Searched by hand, as GCC rejects string_view::find() on a
+            // template parameter's chars
+            std::size_t close = 0;
+            while (close < name.size() && name[close] != ']')
+                ++close;
+            if (!name.empty() && name[0] == '[' && close < name.size()) {
+                s = name.substr(1, close - 1);
+                sec = &s;
+                name.remove_prefix(close + 1);
+            }
+            auto i = first_kvp(sec, name);
+            if (i != layout_type::no_kvp && std::find(hot, hot + hot_count, i) == hot + hot_count)
+                hot[hot_count++] = i;
+        });
+        detail::pack_hot(kvp_buffer, sizes.chars, sizes.key_chars, kvp_table.data(), kvpcount(),
+            section_table.data(), section_count, hot, hot_count, detail::fixed_scratch<verify_and_size() + 1>{});
 
-        constexpr const auto& operator*() const noexcept {
-            return m_current;
+        for (unsigned int h = 0; h < hot_count; ++h) {
+            const auto& k = kvp_table[hot[h]];
+            auto key = view_type(kvp_buffer + k.key, k.key_size);
+            auto sec = k.section != detail::npos<offset_type> ? view_type(kvp_buffer + k.section) : view_type();
+            hot_table[h].kvp = static_cast<index_entry>(hot[h]);
+            hot_table[h].global = first_kvp(nullptr, key) == hot[h];
+            hot_table[h].scoped = k.section != detail::npos<offset_type> && first_kvp(&sec, key) == hot[h];
         }
-        constexpr const auto *operator->() const noexcept {
-            return &m_current;
+    }
+    // Finds the kvp that a lookup would, by scanning the tables, as GCC
+    // rejects comparing find_section()'s result to nullptr while the config
+    // is being constructed
+    constexpr unsigned int first_kvp(const view_type *sec, view_type key) const noexcept {
+        unsigned int first = 0;
+        unsigned int last = kvpcount();
+        if (sec != nullptr) {
+            unsigned int s = 0;
+            while (s < section_count && !detail::stringmatch(kvp_buffer + section_table[s].name, *sec))
+                ++s;
+            if (s == section_count)
+                return layout_type::no_kvp;
+            first = section_table[s].index;
+            last = first + section_table[s].count;
         }
-        constexpr auto& operator++() noexcept {
-            get_next();
-            return *this;
+        for (auto i = first; i < last; ++i) {
+            if (view_type(kvp_buffer + kvp_table[i].key, kvp_table[i].key_size) == key)
+                return i;
         }
-        constexpr auto operator++(int) noexcept {
-            auto copy = *this;
-            get_next();
-            return copy;
+        return layout_type::no_kvp;
+    }
+
+    // Checks the profile's kvps for a run-time lookup, returning no_kvp if
+    // the key is not one of them
+    constexpr unsigned int find_hot(const view_type *sec, const basic_key<char_type>& key) const noexcept {
+        for (const auto& e : hot_table) {
+            if (!(sec != nullptr ? e.scoped : e.global))
+                continue;
+            const auto& k = kvp_table[e.kvp];
+            if (k.key_hash == key.short_hash() &&
+                detail::equal_views(view_type(kvp_buffer + k.key, k.key_size), key.name()) &&
+                (sec == nullptr || detail::stringmatch(kvp_buffer + k.section, *sec)))
+            {
+                return e.kvp;
+            }
         }
-        constexpr auto operator<=>(const iterator& other) const noexcept {
-            if (auto poscomp = m_pos <=> other.m_pos; poscomp != 0)
-                return poscomp;
-            if (m_current.first == nullptr)
-                return std::strong_ordering::greater;
-            else if (other.m_current.first == nullptr)
-                return std::strong_ordering::less;
-            else
-                return m_current.first <=> other.m_current.first;
+        return layout_type::no_kvp;
+    }
+
+    // Converts the value of the given kvp from the text, as the buffer may
+    // not hold it
+    template<typename T>
+    constexpr static detail::number<T> convert_text(unsigned int i) noexcept {
+        detail::number<T> n;
+        unsigned int at = 0;
+        detail::tokenize_kept(input.data, input.data + std::size(input.data), text_filter{},
+            [](auto, auto) {},
+            [&](auto, auto, auto value, auto value_end) {
+                if (at++ == i)
+                    n = detail::to_number<T>(value, value_end);
+            });
+        return n;
+    }
+
+    // Converts values from the text, as the buffer may not hold them all
+    consteval void fill_value_cache() noexcept {
+        unsigned int i = 0;
+        detail::tokenize_kept(input.begin(), input.end(), text_filter{}, [](auto, auto) {},
+            [&](auto, auto, auto value, auto value_end) {
+                int_cache[i] = detail::scan_integer(value, value_end);
+                float_cache[i] = detail::to_number<double>(value, value_end);
+                bool_cache[i] = detail::to_number<bool>(value, value_end);
+                ++i;
+            });
+    }
+
+    // String keys are taken separately, as a string_container key cannot
+    // convert to a basic_key implicitly
+    constexpr unsigned int find_kvp(const char_type *sec, const char_type *key) const noexcept {
+        return view().find_kvp(sec, basic_key<char_type>(key));
+    }
+    constexpr unsigned int find_kvp(const char_type *sec, const basic_key<char_type>& key) const noexcept {
+        return view().find_kvp(sec, key);
+    }
+
+    // Counts run-time lookups if chosen by the lookup_stats option. The
+    // config itself is constexpr and cannot hold counters, so every config
+    // of this type shares one recorder, kept in static storage so that the
+    // noexcept lookups never allocate.
+    constexpr static bool use_stats = (std::same_as<Options, lookup_stats> || ...);
+    static inline std::array<detail::padded_counter, use_stats ? kvpcount() : 0> stats_hits;
+    static inline constinit detail::lookup_recorder stats_recorder{std::span(stats_hits)};
+    static detail::lookup_recorder& stats() noexcept {
+        return stats_recorder;
+    }
+    // Finds the kvp for a run-time lookup
+    unsigned int lookup(const view_type *sec, const basic_key<char_type>& key) const noexcept {
+        auto find = [this](const view_type *s, const basic_key<char_type>& k) {
+            if constexpr (use_hot) {
+                if (auto i = find_hot(s, k); i != layout_type::no_kvp)
+                    return i;
+            }
+            return view().find_kvp(s, k);
+        };
+        if constexpr (use_stats)
+            return detail::recorded_find(&stats(), sec, key, find);
+        else
+            return find(sec, key);
+    }
+
+    // Converts the value of the given kvp as to_number<T>() would, using
+    // the value cache if enabled (floats are narrowed from the cached double).
+    // A missing kvp converts to zero.
+    // Dropped number text is only converted at compile-time.
+    template<typename T>
+    constexpr detail::number<T> convert_kvp(unsigned int i) const noexcept {
+        if (i == layout_type::no_kvp)
+            return {};
+        if constexpr (!use_cache) {
+            if constexpr (drop_text) {
+                if (std::is_constant_evaluated())
+                    return convert_text<T>(i);
+            }
+            return detail::to_number<T>(kvp_buffer + kvp_table[i].value);
         }
-        constexpr bool operator==(const iterator& other) const noexcept {
-            return m_pos == other.m_pos && m_current.first == other.m_current.first;
+        else if constexpr (std::same_as<T, bool>)
+            return bool_cache[i];
+        else if constexpr (std::integral<T>)
+            return detail::to_integer<T>(int_cache[i]);
+        else
+            return detail::narrow<T>(float_cache[i]);
+    }
+
+    // Lookups for detail::lookup_surface
+    detail::found_value<char_type> find_value(const view_type *sec,
+        const basic_key<char_type>& key) const noexcept
+    {
+        auto i = lookup(sec, key);
+        return { view().value_of(i), i };
+    }
+    template<typename T>
+    constexpr detail::number<T> convert_value(const detail::found_value<char_type>& v) const noexcept {
+        return convert_kvp<T>(v.kvp);
+    }
+
+    // Implements tryget_many()
+    std::size_t many(const view_type *sec, std::span<const char_type *const> keys,
+        std::span<const char_type *> values) const
+    {
+        detail::check_batch(keys.size(), values.size());
+        std::size_t found = 0;
+        detail::find_many(view(), sec, keys.data(), keys.size(),
+            [&](std::size_t i, unsigned int k) {
+                values[i] = k != layout_type::no_kvp ? kvp_buffer + kvp_table[k].value : nullptr;
+                found += k != layout_type::no_kvp;
+                if constexpr (use_stats)
+                    detail::record_batched(stats(), sec, view_type(keys[i]), k);
+            });
+        return found;
+    }
+
+    // Sets one field of a bind() result from its key in the given section
+    template<typename T, string_container Name, typename M>
+    consteval void bind_field(T& out, const char_type *sec, const field_binding<Name, T, M>& f) const {
+        static_assert(std::same_as<typename decltype(Name)::char_type, char_type>,
+            "Field names must have the config's char type!");
+        auto i = find_kvp(sec, Name);
+        if (i == layout_type::no_kvp)
+            throw "Unknown key!";
+
+        if constexpr (std::same_as<M, const char_type *>) {
+            out.*f.member = kvp_buffer + kvp_table[i].value;
+        } else if constexpr (std::same_as<M, view_type>) {
+            out.*f.member = view().value_of(i);
+        } else {
+            static_assert(std::integral<M> || std::floating_point<M>,
+                "Fields must be numbers, const char_type *, or basic_string_view!");
+            auto n = convert_kvp<M>(i);
+            if (n.status == detail::number_status::invalid)
+                throw "Invalid value!";
+            if (n.status == detail::number_status::out_of_range)
+                throw "Value out of range!";
+            out.*f.member = n.value;
         }
-    };
+    }
+
+    // Sets every field of a bind() result
+    template<typename T, std::size_t... I>
+    consteval void bind_fields(T& out, const char_type *sec, std::index_sequence<I...>) const {
+        (bind_field(out, sec, std::get<I>(binding<T>::fields)), ...);
+    }
+
+    // Creates a handle() result for the given kvp, found through find_kvp()
+    template<typename T>
+    consteval auto make_handle(unsigned int i) const {
+        if (i == layout_type::no_kvp)
+            throw "Unknown key!";
+
+        auto offset = kvp_table[i].value;
+        if constexpr (std::is_void_v<T>)
+            return key_handle(offset);
+        else
+            return typed_key_handle<T>(offset, convert_kvp<T>(i).value);
+    }
+
+public:
+    // Stores a key-value pair, including a section identifier
+    using kvp = detail::kvp<char_type>;
+    using iterator = const kvp *;
+    using section_view = detail::section_view<iterator>;
+    // A section directory entry, as returned by find_section()
+    using section_entry = detail::section_entry<offset_type>;
 
     /**
      * Constructs the ini_config object, populating the section/key/value
-     * buffer.
+     * buffer and the lookup index.
      */
-    consteval ini_config() noexcept
-#ifdef TCSULLIVAN_INI_CONFIG_CHECK_FORWARD_ITERATOR
-        requires(std::forward_iterator<iterator>)
+    consteval ini_config()
+#ifdef TCSULLIVAN_INI_CONFIG_CHECK_RANDOM_ACCESS_ITERATOR
+        requires(std::random_access_iterator<iterator>)
 #endif
     {
-        fill_kvp_buffer();
+        section_count = detail::fill_kvp_buffer(input.begin(), input.end(),
+            sizes.key_chars, kvp_buffer, kvp_table.data(), section_table.data(), text_filter{});
+        fill_index();
+        if constexpr (profile_type::size > 0)
+            fill_hot();
+        if constexpr (use_cache)
+            fill_value_cache();
+    }
+
+    /**
+     * Returns the config as a precompiled blob for basic_blob_config, so
+     * that a build step can write out the same format that run-time configs
+     * produce. Declare the result alignas(8) to load it in place.
+     */
+    consteval auto blob() const {
+        static_assert(!drop_text, "Blobs need the text of every value!");
+        constexpr auto plan = detail::plan_blob<char_type>(kvpcount(), sectioncount(),
+            detail::index_size<index_policy>(kvpcount()), detail::index_buckets<index_policy>(kvpcount()),
+            verify_and_size() + 1);
+        std::array<unsigned char, plan.size> out = {};
+        detail::write_blob(view(), plan, out.data());
+        return out;
     }
 
     /**
@@ -329,59 +3267,76 @@ public:
         return kvpcount();
     }
 
-    constexpr auto begin() const noexcept {
-        return iterator(kvp_buffer);
+    constexpr iterator begin() const noexcept {
+        return kvp_list();
     }
-    constexpr auto end() const noexcept {
-        return iterator(kvp_buffer + sizeof(kvp_buffer) / sizeof(char_type) - 1);
+    constexpr iterator end() const noexcept {
+        return kvp_list() + kvpcount();
     }
-    constexpr auto cbegin() const noexcept {
+    constexpr iterator cbegin() const noexcept {
         return begin();
     }
-    constexpr auto cend() const noexcept {
+    constexpr iterator cend() const noexcept {
         return end();
     }
 
+    /**
+     * Finds the given section in the section directory, returning a handle
+     * for use with begin(), end(), and section(). Returns nullptr if the
+     * section does not exist or has no key-value pairs.
+     */
+    constexpr const section_entry *find_section(const char_type *section) const noexcept {
+        return view().find_section(section);
+    }
+    constexpr const section_entry *find_section(view_type section) const noexcept {
+        return view().find_section(section);
+    }
+
     /**
      * Returns beginning iterator for the given section.
+     * If a section appears more than once, only its first run of key-value
+     * pairs is covered.
      */
+    constexpr iterator begin(const section_entry& section) const noexcept {
+        return begin() + section.index;
+    }
     constexpr auto begin(const char_type *section) const noexcept {
-        auto it = begin();
-        do {
-            if (it->section != nullptr && stringmatch(it->section, section))
-                break;
-        } while (++it != end());
-        return it;
+        auto sec = find_section(section);
+        return sec != nullptr ? begin(*sec) : end();
     }
-    
-    /** 
+    constexpr auto begin(view_type section) const noexcept {
+        auto sec = find_section(section);
+        return sec != nullptr ? begin(*sec) : end();
+    }
+
+    /**
      * Returns end iterator for the given section.
      */
+    constexpr iterator end(const section_entry& section) const noexcept {
+        return begin() + section.index + section.count;
+    }
     constexpr auto end(const char_type *section) const noexcept {
-        auto it = begin(section);
-        while (++it != end() && stringmatch(it->section, section));
-        return it;
+        auto sec = find_section(section);
+        return sec != nullptr ? end(*sec) : end();
+    }
+    constexpr auto end(view_type section) const noexcept {
+        auto sec = find_section(section);
+        return sec != nullptr ? end(*sec) : end();
     }
-
-    class section_view {
-        iterator m_begin;
-        iterator m_end;
-    public:
-        constexpr section_view(const ini_config& ini, const char_type *section)
-            : m_begin(ini.begin(section)), m_end(ini.end(section)) {}
-        constexpr auto begin() const noexcept {
-            return m_begin;
-        }
-        constexpr auto end() const noexcept {
-            return m_end;
-        }
-    };
 
     /**
      * Creates a 'view' for the given section, for use with ranged for.
      */
+    constexpr auto section(const section_entry& s) const noexcept {
+        return section_view(begin(s), end(s), s.count);
+    }
     constexpr auto section(const char_type *s) const noexcept {
-        return section_view(*this, s);
+        auto sec = find_section(s);
+        return sec != nullptr ? section(*sec) : section_view(end(), end(), 0);
+    }
+    constexpr auto section(view_type s) const noexcept {
+        auto sec = find_section(s);
+        return sec != nullptr ? section(*sec) : section_view(end(), end(), 0);
     }
 
     /**
@@ -390,10 +3345,10 @@ public:
      */
     consteval auto get(const char_type *key) const noexcept {
         for (auto kvp : *this) {
-            if (stringmatch(kvp.first, key))
+            if (detail::stringmatch(kvp.first, key))
                 return kvp.second;
         }
-        return "";
+        return detail::empty_string<char_type>;
     }
     /**
      * Returns the value for the given key, converted to the given type.
@@ -401,7 +3356,7 @@ public:
      */
     template<typename T> requires(std::integral<T> || std::floating_point<T>)
     consteval T get(const char_type *key) const noexcept {
-        return from_string<T>(get(key));
+        return convert_kvp<T>(find_kvp(nullptr, key)).value;
     }
     /**
      * Returns the value for the given key in the given section.
@@ -409,10 +3364,10 @@ public:
      */
     consteval auto get(const char_type *sec, const char_type *key) const noexcept {
         for (auto kvp : section(sec)) {
-            if (stringmatch(kvp.first, key))
+            if (detail::stringmatch(kvp.first, key))
                 return kvp.second;
         }
-        return "";
+        return detail::empty_string<char_type>;
     }
     /**
      * Returns the value for the given key in the given section,
@@ -421,47 +3376,171 @@ public:
      */
     template<typename T> requires(std::integral<T> || std::floating_point<T>)
     consteval T get(const char_type *sec, const char_type *key) const noexcept {
-        return from_string<T>(get(sec, key));
+        return convert_kvp<T>(find_kvp(sec, key)).value;
     }
 
     /**
-     * tryget() calls are for run-time use when 'sec' or 'key'
-     * is not known at compile-time.
+     * tryget(), tryget_view(), tryget_many(), trycontains(), and
+     * tryconvert() are for run-time use when 'sec' or 'key' is not known
+     * at compile-time (see detail::lookup_surface). Typed lookups use the
+     * value cache if enabled.
      */
-    auto tryget(const char_type *key) const noexcept {
-        for (auto kvp : *this) {
-            if (stringmatch(kvp.first, key))
-                return kvp.second;
-        }
-        return "";
+    using lookups::tryget;
+    using lookups::trycontains;
+
+    /**
+     * Run-time lookups for callers holding strings of the original char type,
+     * when the text is stored as UTF-8 (see utf8_storage). The section and
+     * key are transcoded to UTF-8, and values back from it.
+     */
+    std::basic_string<input_char_type> tryget(input_view_type key) const requires(use_utf8) {
+        return transcode<input_char_type>(this->tryget_view(transcode<char_type>(key)));
     }
-    template<typename T> requires(std::integral<T> || std::floating_point<T>)
-    T tryget(const char_type *key) const noexcept {
-        return from_string<T>(tryget(key));
+    std::basic_string<input_char_type> tryget(input_view_type sec, input_view_type key) const
+        requires(use_utf8)
+    {
+        return transcode<input_char_type>(this->tryget_view(transcode<char_type>(sec), transcode<char_type>(key)));
     }
-    auto tryget(const char_type *sec, const char_type *key) const noexcept {
-        for (auto kvp : section(sec)) {
-            if (stringmatch(kvp.first, key))
-                return kvp.second;
-        }
-        return "";
+    template<typename T> requires(use_utf8 && (std::integral<T> || std::floating_point<T>))
+    T tryget(input_view_type key) const {
+        return tryget<T>(transcode<char_type>(key));
     }
-    template<typename T> requires(std::integral<T> || std::floating_point<T>)
-    T tryget(const char_type *sec, const char_type *key) const noexcept {
-        return from_string<T>(tryget(sec, key));
+    template<typename T> requires(use_utf8 && (std::integral<T> || std::floating_point<T>))
+    T tryget(input_view_type sec, input_view_type key) const {
+        return tryget<T>(transcode<char_type>(sec), transcode<char_type>(key));
+    }
+    bool trycontains(input_view_type key) const requires(use_utf8) {
+        return trycontains(transcode<char_type>(key));
+    }
+    bool trycontains(input_view_type sec, input_view_type key) const requires(use_utf8) {
+        return trycontains(transcode<char_type>(sec), transcode<char_type>(key));
+    }
+
+    /**
+     * With the lookup_stats option, returns the run-time lookups counted so
+     * far as JSON: hits per key, misses per query hash (as given by
+     * ini_config::key's hash()), and lookup latencies. Counts are shared by
+     * all configs of this type. Batches from tryget_many() are counted but
+     * not timed.
+     */
+    std::string stats_json() const requires(use_stats) {
+        return stats().json(view());
+    }
+
+    consteval bool contains(const char_type *key) const noexcept {
+        return find_kvp(nullptr, key) != layout_type::no_kvp;
+    }
+    consteval bool contains(const char_type *sec, const char_type *key) const noexcept {
+        return find_kvp(sec, key) != layout_type::no_kvp;
     }
 
+    /**
+     * Checks if the given key exists and its entire value converts to the
+     * given type (e.g. "9" is an int, "4.5" is a double, "yes" is a bool).
+     */
+    template<typename T> requires(std::integral<T> || std::floating_point<T>)
     consteval bool contains(const char_type *key) const noexcept {
-        return *get(key) != '\0';
+        return convert_kvp<T>(find_kvp(nullptr, key)).status == detail::number_status::ok;
     }
+    template<typename T> requires(std::integral<T> || std::floating_point<T>)
     consteval bool contains(const char_type *sec, const char_type *key) const noexcept {
-        return *get(sec, key) != '\0';
+        return convert_kvp<T>(find_kvp(sec, key)).status == detail::number_status::ok;
+    }
+
+    /**
+     * Converts the value of the given key to the given type, or returns why
+     * it could not: the key is missing, the value is not entirely a number
+     * of that type, or the number does not fit in it.
+     */
+    template<typename T> requires(std::integral<T> || std::floating_point<T>)
+    consteval conversion_result<T> convert(const char_type *key) const noexcept {
+        auto i = find_kvp(nullptr, key);
+        return detail::make_result(i != layout_type::no_kvp, convert_kvp<T>(i));
     }
-    bool trycontains(const char_type *key) const noexcept {
-        return *tryget(key) != '\0';
+    template<typename T> requires(std::integral<T> || std::floating_point<T>)
+    consteval conversion_result<T> convert(const char_type *sec, const char_type *key) const noexcept {
+        auto i = find_kvp(sec, key);
+        return detail::make_result(i != layout_type::no_kvp, convert_kvp<T>(i));
+    }
+
+    /**
+     * A key's value location, resolved at compile-time by handle().
+     * Reading it through operator[] needs no lookup or string compare.
+     */
+    class key_handle {
+        friend class ini_config;
+        offset_type m_offset = 0;
+    protected:
+        constexpr explicit key_handle(offset_type offset) noexcept
+            : m_offset(offset) {}
+    public:
+        constexpr auto offset() const noexcept {
+            return m_offset;
+        }
+    };
+    /**
+     * A key_handle that also holds the value converted to the given type.
+     */
+    template<typename T>
+    class typed_key_handle : public key_handle {
+        friend class ini_config;
+        T m_value;
+        constexpr typed_key_handle(offset_type offset, T value) noexcept
+            : key_handle(offset), m_value(value) {}
+    public:
+        constexpr T value() const noexcept {
+            return m_value;
+        }
+    };
+
+    /**
+     * Returns a handle for the given key, or for the given key in the given
+     * section. If a type is given, the handle also holds the value converted
+     * to that type. A key that does not exist is a compile-time error.
+     */
+    template<string_container Key, typename T = void>
+        requires(std::same_as<typename decltype(Key)::char_type, char_type> &&
+            (std::is_void_v<T> || std::integral<T> || std::floating_point<T>))
+    consteval auto handle() const {
+        return make_handle<T>(find_kvp(nullptr, Key));
     }
-    bool trycontains(const char_type *sec, const char_type *key) const noexcept {
-        return *tryget(sec, key) != '\0';
+    template<string_container Sec, string_container Key, typename T = void>
+        requires(std::same_as<typename decltype(Sec)::char_type, char_type> &&
+            std::same_as<typename decltype(Key)::char_type, char_type> &&
+            (std::is_void_v<T> || std::integral<T> || std::floating_point<T>))
+    consteval auto handle() const {
+        // Sec is passed as a view, as GCC rejects comparing its address to
+        // nullptr
+        auto sec = view_type(Sec.data, std::size(Sec.data) - 1);
+        return make_handle<T>(view().find_kvp(&sec, basic_key<char_type>(Key)));
+    }
+
+    /**
+     * Fills an aggregate from the keys of the given section (or of the
+     * entire config, for the first match of each key), as described by
+     * binding<T>. Each field is converted to its member's type; a missing
+     * key, or a value that is not entirely a number in range of its
+     * field's type, is a compile-time error. String fields point into the
+     * config, so the config must outlive the result.
+     */
+    template<typename T>
+    consteval T bind(const char_type *sec = nullptr) const {
+        T out = {};
+        bind_fields(out, sec,
+            std::make_index_sequence<std::tuple_size_v<decltype(binding<T>::fields)>>());
+        return out;
+    }
+
+    /**
+     * Reads the value referred to by a handle: a string for key_handle,
+     * or the converted value for typed_key_handle.
+     */
+    constexpr const char_type *operator[](key_handle h) const noexcept {
+        return kvp_buffer + h.offset();
+    }
+    template<typename T>
+    constexpr T operator[](typed_key_handle<T> h) const noexcept {
+        return h.value();
     }
 };
 
@@ -476,10 +3555,19 @@ consteval auto operator ""_ini()
     return ini_config::ini_config<Input>();
 }
 
+/**
+ * _key suffix definition, for a key hashed at compile-time.
+ */
+template <ini_config::string_container Key>
+consteval auto operator ""_key()
+{
+    using char_type = typename decltype(Key)::char_type;
+    return ini_config::basic_key<char_type>(std::basic_string_view<char_type>(Key.begin(), Key.size() - 1));
+}
+
 // For MSVC, the below alternative seems promising, though
 // MSVC v19.28 complains about running out of heap.
-template <ini_config::string_container Input>
-constexpr auto make_ini_config = ini_config::ini_config<Input>();
+template <ini_config::string_container Input, typename... Options>
+constexpr auto make_ini_config = ini_config::ini_config<Input, Options...>();
 
 #endif // TCSULLIVAN_INI_CONFIG_HPP
-
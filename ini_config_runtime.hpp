@@ -0,0 +1,2246 @@
+/**
+ * ini_config_runtime.hpp - Configs parsed, mapped, or loaded at run-time, for
+ * INI text that is not known at compile-time. Builds on ini_config.hpp,
+ * which holds the compile-time config and everything the two share.
+ * Written by Clyne Sullivan.
+ * https://github.com/tcsullivan/ini-config
+ */
+
+#ifndef TCSULLIVAN_INI_CONFIG_RUNTIME_HPP
+#define TCSULLIVAN_INI_CONFIG_RUNTIME_HPP
+
+// Uncomment below to disable parsing large run-time texts on several threads
+//#define TCSULLIVAN_INI_CONFIG_NO_THREADS
+
+#include "ini_config.hpp"
+
+#include <algorithm> // std::copy, std::copy_n, std::count_if, std::find, std::lower_bound, std::max, std::min
+#include <atomic> // std::atomic, std::atomic_exchange_explicit, std::atomic_load_explicit
+#include <cstddef> // std::byte, std::max_align_t, std::size_t
+#include <cstdint> // std::uint32_t, std::uint64_t, std::uintptr_t
+#include <cstdio> // std::fclose, std::ferror, std::fopen, std::fread
+#include <cstring> // std::memcpy, std::memset
+#include <memory> // std::allocator_arg_t, std::make_shared, std::shared_ptr, std::unique_ptr
+#include <memory_resource> // std::pmr::memory_resource, std::pmr::monotonic_buffer_resource, std::pmr::vector
+#include <mutex> // std::lock_guard, std::mutex, std::unique_lock
+#include <span> // std::span
+#include <stdexcept> // std::runtime_error
+#include <string> // std::pmr::string, std::string, std::to_string
+#include <string_view> // std::basic_string_view, std::string_view
+#include <system_error> // std::system_error
+#include <tuple> // std::get, std::tie
+#include <unordered_map> // std::pmr::unordered_map
+#include <unordered_set> // std::pmr::unordered_set
+#include <utility> // std::exchange, std::forward, std::index_sequence_for, std::move, std::pair
+
+#ifndef TCSULLIVAN_INI_CONFIG_NO_THREADS
+#include <thread> // std::jthread, std::thread::hardware_concurrency
+#endif
+
+#if defined(__cpp_impl_coroutine) && __has_include(<coroutine>)
+#define TCSULLIVAN_INI_CONFIG_HAS_COROUTINES
+#include <condition_variable> // std::condition_variable
+#include <coroutine> // std::coroutine_handle, std::noop_coroutine, std::suspend_always
+#include <exception> // std::current_exception, std::exception_ptr, std::rethrow_exception
+#include <optional> // std::optional
+#endif
+
+#if __has_include(<sys/mman.h>)
+#define TCSULLIVAN_INI_CONFIG_HAS_MMAP
+#include <fcntl.h> // ::open
+#include <sys/mman.h> // ::mmap, ::munmap
+#include <sys/stat.h> // ::fstat
+#include <unistd.h> // ::close
+#endif
+
+namespace ini_config {
+
+namespace detail {
+
+// Run-time configs remember a summary of each block of their text, so that
+// a reload can reuse the blocks that did not change. A block is a section
+// header and the lines under it, or the lines before the first header.
+
+// Hashes raw text a word at a time, for telling changed blocks apart
+inline std::uint64_t text_hash(const void *data, std::size_t size) noexcept {
+    auto p = static_cast<const unsigned char *>(data);
+    std::uint64_t h = fnv1a_basis ^ size;
+    for (; size >= 8; p += 8, size -= 8) {
+        std::uint64_t w;
+        std::memcpy(&w, p, sizeof(w));
+        h = std::rotl((h ^ w) * 0x9E3779B97F4A7C15ull, 29);
+    }
+    std::uint64_t w = 0;
+    std::memcpy(&w, p, size);
+    return mix(h ^ w, 0);
+}
+// Chains a section name or key onto a block's key hash
+template<typename char_type>
+constexpr std::uint64_t key_hash_step(std::uint64_t h, const char_type *first,
+    const char_type *last) noexcept
+{
+    return (fnv1a(first, last, h) ^ 0xFF) * 0x100000001B3ull;
+}
+
+// A block found by split_blocks()
+template<typename char_type>
+struct text_block {
+    const char_type *first = nullptr;
+    const char_type *last = nullptr;
+    const char_type *name = nullptr; // Section name, empty for the leading block
+    const char_type *name_end = nullptr;
+    unsigned int line = 0;           // Lines of text before the block
+    unsigned int kvps = 0;           // Lines holding key-value pairs
+    std::uint64_t hash = 0;          // text_hash() of [first, last)
+};
+
+// What a config keeps of each block
+struct block_record {
+    std::uint64_t text_hash = 0;
+    std::uint64_t key_hash = 0; // Of the section name and keys, in order
+    std::uint32_t text_size = 0;
+    std::uint32_t kvps = 0;
+};
+
+// Splits text into blocks by finding the lines that tokenize() takes for
+// section headers. Blocks begin at the header's '['. Lines are not
+// validated; kvps counts the lines that would be key-value pairs.
+template<typename char_type>
+std::pmr::vector<text_block<char_type>> split_blocks(const char_type *begin, const char_type *end,
+    std::pmr::memory_resource *resource)
+{
+    std::pmr::vector<text_block<char_type>> blocks(1, resource);
+    blocks.back().first = begin;
+    unsigned int lines = 0;
+
+    for (auto line = begin; line != end;) {
+        auto eol = lineend(line, end);
+        auto p = line;
+        line = eol != end ? eol + 1 : end;
+        ++lines;
+
+        for (; p != eol && !isgraph(*p); ++p);
+        if (p == eol || iscomment(*p))
+            continue;
+
+        if (*p == '[') {
+            blocks.back().last = p;
+            auto& b = blocks.emplace_back();
+            b.first = p;
+            b.name = p + 1;
+            b.name_end = std::find(b.name, eol, ']');
+            b.line = lines - 1;
+        } else {
+            ++blocks.back().kvps;
+        }
+    }
+    blocks.back().last = end;
+
+    for (auto& b : blocks)
+        b.hash = text_hash(b.first, static_cast<std::size_t>(b.last - b.first) * sizeof(char_type));
+    return blocks;
+}
+
+#ifndef TCSULLIVAN_INI_CONFIG_NO_THREADS
+// Calls fn(i) for each i in [0, count), each on its own thread (the last on
+// the calling thread). Calls run on the calling thread instead if threads
+// cannot be started.
+template<typename Fn>
+void parallel_for(std::size_t count, std::pmr::memory_resource *resource, Fn&& fn) {
+    std::pmr::vector<std::jthread> threads(resource);
+    threads.reserve(count);
+    std::size_t i = 0;
+    try {
+        for (; i + 1 < count; ++i)
+            threads.emplace_back([&fn, i] { fn(i); });
+    } catch (const std::system_error&) {}
+    for (; i < count; ++i)
+        fn(i);
+}
+#endif
+
+// Makes scratch arrays for building an index at run-time, allocated from
+// the given memory resource
+struct resource_scratch {
+    std::pmr::memory_resource *resource = std::pmr::get_default_resource();
+
+    template<typename T>
+    std::pmr::vector<T> make(std::size_t count) const {
+        return std::pmr::vector<T>(count, resource);
+    }
+};
+
+// Returns a block_plan allocation to its memory resource
+struct resource_deleter {
+    std::pmr::memory_resource *resource = nullptr;
+    std::size_t size = 0;
+
+    void operator()(std::byte *p) const noexcept {
+        resource->deallocate(p, size, alignof(std::max_align_t));
+    }
+};
+
+// Plans a single allocation that holds several arrays
+class block_plan {
+    std::size_t m_size = 0;
+public:
+    // Reserves space for 'count' objects, returning their byte offset
+    template<typename T>
+    std::size_t add(std::size_t count) noexcept {
+        auto at = (m_size + alignof(T) - 1) / alignof(T) * alignof(T);
+        m_size = at + count * sizeof(T);
+        return at;
+    }
+    std::size_t size() const noexcept {
+        return m_size;
+    }
+};
+
+// Memory-mapped configs are not copied into a kvp buffer. Instead, their
+// tables locate strings within the mapped text by offset and length.
+
+// Locations of a key-value pair's strings within the text
+struct span_offsets {
+    std::uint32_t section = npos<std::uint32_t>; // npos if kvp precedes all sections
+    std::uint32_t section_size = 0;
+    std::uint32_t key = 0;
+    std::uint32_t key_size = 0;
+    std::uint32_t value = 0;
+    std::uint32_t value_size = 0;
+    std::uint32_t key_hash = 0; // See key_hash()
+};
+
+// A section directory entry, describing a section's first run of kvps
+struct span_section {
+    std::uint32_t name = 0;
+    std::uint32_t name_size = 0;
+    std::uint32_t index = 0; // Position of the run's first kvp
+    std::uint32_t count = 0; // Number of kvps in the run
+};
+
+// Stores a key-value pair, including a section identifier
+// (section is empty if the kvp precedes all sections)
+template<typename char_type>
+struct span_kvp {
+    std::basic_string_view<char_type> section;
+    std::basic_string_view<char_type> first;
+    std::basic_string_view<char_type> second;
+};
+
+template<typename char_type>
+constexpr span_kvp<char_type> make_kvp(const char_type *text, const span_offsets& e) noexcept {
+    using view_type = std::basic_string_view<char_type>;
+    return {
+        e.section != npos<std::uint32_t> ? view_type(text + e.section, e.section_size) : view_type(),
+        view_type(text + e.key, e.key_size),
+        view_type(text + e.value, e.value_size)
+    };
+}
+
+template<typename char_type>
+using span_iterator = iterator<char_type, span_offsets>;
+
+// A non-owning view of a memory-mapped config's tables and lookup index,
+// matching layout's interface for the index builders.
+template<typename char_type, typename index_policy>
+struct span_layout {
+    using entry_type = std::uint32_t;
+    using view_type = std::basic_string_view<char_type>;
+
+    constexpr static bool use_hash = std::same_as<index_policy, perfect_hash_index>;
+    constexpr static bool use_sorted = std::same_as<index_policy, sorted_index>;
+    constexpr static entry_type index_global = entry_type(1) << 31;
+    constexpr static entry_type index_empty = ~entry_type(0);
+    constexpr static unsigned int no_kvp = ~0u;
+
+    const char_type *text = nullptr;
+    const span_offsets *kvps = nullptr;
+    unsigned int kvp_count = 0;
+    const span_section *sections = nullptr;
+    unsigned int section_count = 0;
+    const entry_type *index = nullptr;
+    unsigned int index_size = 0; // Hash slots, or sorted entries
+    const std::uint16_t *seeds = nullptr;
+    unsigned int bucket_count = 0;
+
+    constexpr view_type entry_section(entry_type e) const noexcept {
+        return view_type(text + kvps[e].section, kvps[e].section_size);
+    }
+    constexpr view_type entry_key(entry_type e) const noexcept {
+        const auto& kvp = kvps[e & ~index_global];
+        return view_type(text + kvp.key, kvp.key_size);
+    }
+    constexpr std::uint64_t entry_hash(entry_type e) const noexcept {
+        return (e & index_global) ? hash(entry_key(e)) : hash(entry_section(e), entry_key(e));
+    }
+    // Orders index entries as layout::compare_entry() does
+    constexpr std::strong_ordering compare_scope(entry_type e, const view_type *sec) const noexcept {
+        if (bool global = e & index_global; global != (sec == nullptr))
+            return global ? std::strong_ordering::less : std::strong_ordering::greater;
+        return sec != nullptr ? entry_section(e).compare(*sec) <=> 0 : std::strong_ordering::equal;
+    }
+    constexpr std::strong_ordering compare_key(entry_type e, view_type key) const noexcept {
+        return entry_key(e).compare(key) <=> 0;
+    }
+    constexpr std::strong_ordering compare_entry(entry_type e, const view_type *sec,
+        view_type key) const noexcept
+    {
+        if (auto comp = compare_scope(e, sec); comp != 0)
+            return comp;
+        return compare_key(e, key);
+    }
+    constexpr bool entry_matches(entry_type e, const view_type *sec, view_type key,
+        std::uint32_t key_hash) const noexcept
+    {
+        return kvps[e & ~index_global].key_hash == key_hash && compare_entry(e, sec, key) == 0;
+    }
+    constexpr std::strong_ordering compare_entries(entry_type a, entry_type b) const noexcept {
+        if (bool global = a & index_global; global != bool(b & index_global))
+            return global ? std::strong_ordering::less : std::strong_ordering::greater;
+        if (!(a & index_global)) {
+            if (auto comp = entry_section(a).compare(entry_section(b)) <=> 0; comp != 0)
+                return comp;
+        }
+        return entry_key(a).compare(entry_key(b)) <=> 0;
+    }
+
+    // Lists each kvp once for tryget(key), and again for tryget(sec, key) if
+    // it is in the section directory. Returns the entry count.
+    constexpr unsigned int collect_entries(entry_type *out) const noexcept {
+        unsigned int count = 0;
+
+        auto run = sections;
+        auto runs_end = sections + section_count;
+        for (unsigned int i = 0; i < kvp_count; ++i) {
+            out[count++] = i | index_global;
+
+            while (run != runs_end && i >= run->index + run->count)
+                ++run;
+            if (run != runs_end && i >= run->index)
+                out[count++] = i;
+        }
+
+        return count;
+    }
+
+    constexpr const span_section *find_section(view_type section) const noexcept {
+        for (unsigned int i = 0; i < section_count; ++i) {
+            if (view_type(text + sections[i].name, sections[i].name_size) == section)
+                return sections + i;
+        }
+        return nullptr;
+    }
+
+    // Finds the kvp table position of the given key, or no_kvp.
+    // 'sec' may be nullptr to search all sections.
+    constexpr unsigned int find_kvp(const view_type *sec, const basic_key<char_type>& key) const noexcept {
+        const auto name = key.name();
+        if constexpr (use_hash) {
+            if (bucket_count != 0) [[likely]] {
+                auto h = key.hash(hash_scope(sec));
+                auto d = seeds[reduce(h >> 32, bucket_count)];
+                auto e = index[reduce(mix(h, d), index_size)];
+                if (e == index_empty || !entry_matches(e, sec, name, key.short_hash()))
+                    return no_kvp;
+                return e & ~index_global;
+            }
+        }
+        if constexpr (use_hash || use_sorted) {
+            auto last = index + index_size;
+            auto it = std::lower_bound(index, last, name,
+                [this, sec](auto e, auto k) { return compare_entry(e, sec, k) < 0; });
+            if (it == last || !entry_matches(*it, sec, name, key.short_hash()))
+                return no_kvp;
+            return *it & ~index_global;
+        } else {
+            unsigned int first = 0;
+            unsigned int last = kvp_count;
+            if (sec != nullptr) {
+                auto run = find_section(*sec);
+                if (run == nullptr)
+                    return no_kvp;
+                first = run->index;
+                last = first + run->count;
+            }
+            for (auto i = first; i < last; ++i) {
+                if (kvps[i].key_hash == key.short_hash() && entry_key(i) == name)
+                    return i;
+            }
+            return no_kvp;
+        }
+    }
+
+    constexpr auto begin(unsigned int i = 0) const noexcept {
+        return span_iterator<char_type>(text, kvps + i);
+    }
+    constexpr auto end() const noexcept {
+        return begin(kvp_count);
+    }
+    constexpr auto section(view_type name) const noexcept {
+        using view = section_view<span_iterator<char_type>>;
+        auto sec = find_section(name);
+        return sec != nullptr ? view(begin(sec->index), begin(sec->index + sec->count), sec->count)
+                              : view(end(), end(), 0);
+    }
+};
+
+// Fills the kvp table and section directory for text that passed
+// verify_and_size(), given a section_finder table. Returns the count of
+// section directory entries.
+template<typename char_type>
+unsigned int fill_span_tables(const char_type *begin, const char_type *end,
+    span_offsets *kvps, span_section *sections, std::span<std::uint32_t> slots) noexcept
+{
+    using view_type = std::basic_string_view<char_type>;
+    auto offset = [begin](const char_type *p) {
+        return static_cast<std::uint32_t>(p - begin);
+    };
+
+    auto kptr = kvps;
+    auto section = view_type();
+    std::uint32_t section_hash = 0;
+    bool insection = false;
+    section_finder finder(sections, slots);
+    span_section *run = nullptr;
+
+    tokenize(begin, end,
+        [&](auto name, auto name_end) {
+            section = view_type(name, static_cast<std::size_t>(name_end - name));
+            section_hash = key_hash(name, name_end);
+            insection = true;
+        },
+        [&](auto key, auto key_end, auto value, auto value_end) {
+            // Check if this kvp starts a new run of a section
+            if (!insection) {
+                run = nullptr;
+            } else if (kptr == kvps || (kptr - 1)->section == npos<std::uint32_t> ||
+                view_type(begin + (kptr - 1)->section, (kptr - 1)->section_size) != section)
+            {
+                run = nullptr;
+                if (finder.claim(section_hash, [&](const span_section& e) {
+                        return view_type(begin + e.name, e.name_size) == section;
+                    }))
+                {
+                    run = &finder.back();
+                    run->name = offset(section.data());
+                    run->name_size = static_cast<std::uint32_t>(section.size());
+                    run->index = static_cast<std::uint32_t>(kptr - kvps);
+                }
+            }
+
+            kptr->section = insection ? offset(section.data()) : npos<std::uint32_t>;
+            kptr->section_size = static_cast<std::uint32_t>(section.size());
+            kptr->key = offset(key);
+            kptr->key_size = static_cast<std::uint32_t>(key_end - key);
+            kptr->key_hash = key_hash(key, key_end);
+            kptr->value = offset(value);
+            kptr->value_size = static_cast<std::uint32_t>(value_end - value);
+            ++kptr;
+
+            if (run != nullptr)
+                ++run->count;
+        });
+
+    return finder.count();
+}
+
+// Stands in for lookup_stats state in configs without the option
+struct no_stats {};
+
+// Adds the duration of each phase of a parse to a parse_times. Does nothing
+// unless Enabled, leaving no trace of itself in the parse.
+template<bool Enabled>
+class phase_timer {
+    parse_times& m_times;
+    std::chrono::steady_clock::time_point m_last = std::chrono::steady_clock::now();
+
+public:
+    explicit phase_timer(parse_times& times) noexcept
+        : m_times(times) {}
+
+    // Ends the current phase, which began when the last one ended
+    void lap(std::uint64_t parse_times::*phase) noexcept {
+        auto now = std::chrono::steady_clock::now();
+        m_times.*phase += static_cast<std::uint64_t>(
+            std::chrono::duration_cast<std::chrono::nanoseconds>(now - m_last).count());
+        m_last = now;
+    }
+};
+template<>
+class phase_timer<false> {
+public:
+    explicit phase_timer(no_stats&) noexcept {}
+    void lap(std::uint64_t parse_times::*) noexcept {}
+};
+
+#ifdef TCSULLIVAN_INI_CONFIG_HAS_MMAP
+// A read-only memory mapping of an entire file
+class mapped_file {
+    const char *m_data = nullptr;
+    std::size_t m_size = 0;
+
+    void unmap() noexcept {
+        if (m_size > 0)
+            ::munmap(const_cast<char *>(m_data), m_size);
+    }
+
+public:
+    mapped_file() noexcept = default;
+    explicit mapped_file(const char *path) {
+        int fd = ::open(path, O_RDONLY);
+        if (fd < 0)
+            throw std::runtime_error(std::string("Could not open ") + path);
+
+        struct ::stat st;
+        if (::fstat(fd, &st) != 0) {
+            ::close(fd);
+            throw std::runtime_error(std::string("Could not read ") + path);
+        }
+
+        if (st.st_size > 0) {
+            auto data = ::mmap(nullptr, static_cast<std::size_t>(st.st_size),
+                PROT_READ, MAP_PRIVATE, fd, 0);
+            if (data == MAP_FAILED) {
+                ::close(fd);
+                throw std::runtime_error(std::string("Could not map ") + path);
+            }
+            m_data = static_cast<const char *>(data);
+            m_size = static_cast<std::size_t>(st.st_size);
+        }
+        ::close(fd);
+    }
+    mapped_file(mapped_file&& other) noexcept
+        : m_data(std::exchange(other.m_data, nullptr)),
+          m_size(std::exchange(other.m_size, 0)) {}
+    mapped_file& operator=(mapped_file&& other) noexcept {
+        if (this != &other) {
+            unmap();
+            m_data = std::exchange(other.m_data, nullptr);
+            m_size = std::exchange(other.m_size, 0);
+        }
+        return *this;
+    }
+    ~mapped_file() {
+        unmap();
+    }
+
+    const char *data() const noexcept {
+        return m_data;
+    }
+    std::size_t size() const noexcept {
+        return m_size;
+    }
+};
+#endif // TCSULLIVAN_INI_CONFIG_HAS_MMAP
+
+} // namespace detail
+
+/**
+ * Thrown when basic_runtime_config is given invalid INI text.
+ */
+class parse_error : public std::runtime_error {
+    unsigned int m_line;
+public:
+    parse_error(const char *what, unsigned int line)
+        : std::runtime_error(line == 0 ? std::string(what) :
+              std::string(what) + " (line " + std::to_string(line) + ")"),
+          m_line(line) {}
+    /**
+     * Returns the line where parsing failed, or zero if not tied to a line.
+     */
+    unsigned int line() const noexcept {
+        return m_line;
+    }
+};
+
+/**
+ * Parses INI text as it arrives in chunks (e.g. from read(), a socket, or a
+ * decompressor), without building a config. on_section(name) is called for
+ * each section header, and on_kvp(section, key, value) for each key-value
+ * pair, with string views that are only valid during the call; 'section'
+ * is empty for pairs before the first header. Only the current section's
+ * name and a line split across chunks are kept, so memory does not grow
+ * with the length of the text. The grammar is that of ini_config, and
+ * invalid text throws parse_error.
+ */
+template<typename CharT, typename SectionFn, typename KvpFn>
+class basic_stream_parser
+{
+public:
+    using char_type = CharT;
+    using view_type = std::basic_string_view<char_type>;
+
+private:
+    SectionFn m_on_section;
+    KvpFn m_on_kvp;
+    std::basic_string<char_type> m_section;
+    std::basic_string<char_type> m_partial; // A line begun in an earlier chunk
+    unsigned int m_line = 0;                // Lines parsed so far
+
+    // Tokenizes whole lines
+    void lines(const char_type *first, const char_type *last) {
+        auto sizes = detail::tokenize(first, last,
+            [this](auto name, auto name_end) {
+                m_section.assign(name, name_end);
+                m_on_section(view_type(m_section));
+            },
+            [this](auto key, auto key_end, auto value, auto value_end) {
+                m_on_kvp(view_type(m_section),
+                    view_type(key, static_cast<std::size_t>(key_end - key)),
+                    view_type(value, static_cast<std::size_t>(value_end - value)));
+            });
+        if (sizes.status != detail::parse_status::ok)
+            throw parse_error(detail::parse_message(sizes.status), m_line + sizes.line);
+        m_line += static_cast<unsigned int>(std::count_if(first, last, detail::iseol<char_type>));
+    }
+
+public:
+    basic_stream_parser(SectionFn on_section, KvpFn on_kvp)
+        : m_on_section(std::move(on_section)), m_on_kvp(std::move(on_kvp)) {}
+
+    /**
+     * Parses the whole lines of the next chunk of text. The rest of the
+     * chunk is kept until a later chunk ends its line.
+     */
+    void feed(view_type chunk) {
+        auto first = chunk.data();
+        auto last = first + chunk.size();
+        auto lines_end = last;
+        while (lines_end != first && !detail::iseol(lines_end[-1]))
+            --lines_end;
+
+        if (!m_partial.empty()) {
+            if (lines_end == first) {
+                m_partial.append(first, last);
+                return;
+            }
+            auto eol = detail::lineend(first, last) + 1;
+            m_partial.append(first, eol);
+            lines(m_partial.data(), m_partial.data() + m_partial.size());
+            first = eol;
+        }
+        lines(first, lines_end);
+        m_partial.assign(lines_end, last);
+    }
+
+    /**
+     * Parses the last line, if the text did not end with a newline.
+     */
+    void finish() {
+        if (!m_partial.empty()) {
+            lines(m_partial.data(), m_partial.data() + m_partial.size());
+            m_partial.clear();
+        }
+    }
+
+    /**
+     * Returns the number of whole lines parsed so far.
+     */
+    unsigned int line() const noexcept {
+        return m_line;
+    }
+};
+
+/**
+ * Creates a basic_stream_parser for the given callbacks.
+ */
+template<typename CharT = char, typename SectionFn, typename KvpFn>
+auto make_stream_parser(SectionFn on_section, KvpFn on_kvp) {
+    return basic_stream_parser<CharT, SectionFn, KvpFn>(std::move(on_section), std::move(on_kvp));
+}
+
+/**
+ * A config parsed at run-time, for INI text that is not known until then
+ * (e.g. a file loaded at startup). It shares ini_config's grammar, layout,
+ * and lookup index, and offers the same run-time interface.
+ * Accepts the same index policy options as ini_config.
+ */
+template<typename CharT = char, typename... Options>
+class basic_runtime_config
+    : public detail::lookup_surface<basic_runtime_config<CharT, Options...>, CharT>
+{
+public:
+    using char_type = CharT;
+    using view_type = std::basic_string_view<char_type>;
+
+private:
+    friend detail::lookup_surface<basic_runtime_config, CharT>;
+
+    using offset_type = std::uint32_t;
+    using index_policy = typename detail::find_option<detail::is_index_policy,
+        perfect_hash_index, Options...>::type;
+    using layout_type = detail::layout<char_type, offset_type, std::uint32_t, index_policy>;
+    using kvp_offsets = detail::kvp_offsets<offset_type>;
+
+    // The kvp buffer, tables, index, and block records share a single
+    // allocation from m_resource, which also serves parsing's scratch memory
+    std::pmr::memory_resource *m_resource = std::pmr::get_default_resource();
+    std::unique_ptr<std::byte[], detail::resource_deleter> m_storage;
+    layout_type m_layout = detail::empty_layout<layout_type>();
+    const detail::block_record *m_blocks = nullptr;
+    unsigned int m_block_count = 0;
+
+    // Lookup counts and parse times, if chosen by the lookup_stats option.
+    // The counters are allocated apart from the config, once it is parsed.
+    constexpr static bool use_stats = (std::same_as<Options, lookup_stats> || ...);
+    [[no_unique_address]] std::conditional_t<use_stats,
+        std::unique_ptr<detail::lookup_recorder>, detail::no_stats> m_stats;
+    [[no_unique_address]] std::conditional_t<use_stats, detail::parse_times, detail::no_stats> m_parse_times;
+    using phase_timer = detail::phase_timer<use_stats>;
+
+    void start_stats() {
+        if constexpr (use_stats)
+            m_stats = std::make_unique<detail::lookup_recorder>(m_layout.kvp_count);
+    }
+
+    // Finds the kvp for a run-time lookup
+    unsigned int lookup(const view_type *sec, const basic_key<char_type>& key) const noexcept {
+        if constexpr (use_stats)
+            return detail::recorded_find(m_stats.get(), sec, key, [this](auto s, const auto& k) {
+                return m_layout.find_kvp(s, k);
+            });
+        else
+            return m_layout.find_kvp(sec, key);
+    }
+    detail::found_value<char_type> find_value(const view_type *sec,
+        const basic_key<char_type>& key) const noexcept
+    {
+        auto i = lookup(sec, key);
+        return { m_layout.value_of(i), i };
+    }
+
+    // Locations of everything within the allocation
+    struct tables {
+        kvp_offsets *kvps;
+        detail::section_entry<offset_type> *sections;
+        std::uint32_t *index;
+        std::uint16_t *seeds;
+        detail::block_record *blocks;
+        char_type *buffer;
+    };
+    tables allocate(unsigned int kvps, unsigned int sections, unsigned int index_size,
+        unsigned int buckets, unsigned int blocks, unsigned int chars)
+    {
+        detail::block_plan plan;
+        auto kvps_at = plan.add<kvp_offsets>(kvps);
+        auto sections_at = plan.add<section_entry>(sections);
+        auto index_at = plan.add<std::uint32_t>(index_size);
+        auto seeds_at = plan.add<std::uint16_t>(buckets);
+        auto blocks_at = plan.add<detail::block_record>(blocks);
+        auto buffer_at = plan.add<char_type>(chars);
+
+        // Zeroed, as the fill functions leave counts and unused seeds untouched
+        auto storage = static_cast<std::byte *>(m_resource->allocate(plan.size(), alignof(std::max_align_t)));
+        std::memset(storage, 0, plan.size());
+        m_storage = decltype(m_storage)(storage, { m_resource, plan.size() });
+        m_blocks = reinterpret_cast<detail::block_record *>(storage + blocks_at);
+        m_block_count = blocks;
+        return {
+            reinterpret_cast<kvp_offsets *>(storage + kvps_at),
+            reinterpret_cast<section_entry *>(storage + sections_at),
+            reinterpret_cast<std::uint32_t *>(storage + index_at),
+            reinterpret_cast<std::uint16_t *>(storage + seeds_at),
+            reinterpret_cast<detail::block_record *>(storage + blocks_at),
+            reinterpret_cast<char_type *>(storage + buffer_at)
+        };
+    }
+
+    // Texts of at least this many chars per thread are parsed in parallel
+    constexpr static std::size_t parallel_chars = std::size_t(1) << 20;
+
+    // Parses the text, which has already been measured if 'measured' is not
+    // nullptr (as by config_loader)
+    void parse(const char_type *begin, const char_type *end, const detail::parse_sizes *measured = nullptr) {
+        phase_timer timer(m_parse_times);
+        const auto blocks = detail::split_blocks(begin, end, m_resource);
+        timer.lap(&detail::parse_times::split);
+#ifndef TCSULLIVAN_INI_CONFIG_NO_THREADS
+        auto threads = std::min<std::size_t>(std::thread::hardware_concurrency(),
+            static_cast<std::size_t>(end - begin) / parallel_chars);
+        if (threads > 1 && blocks.size() > 1)
+            return parse_parallel(blocks, threads);
+#endif
+
+        auto sizes = measured != nullptr ? *measured : detail::verify_and_size(begin, end);
+        if (sizes.status != detail::parse_status::ok)
+            throw parse_error(detail::parse_message(sizes.status), sizes.line);
+        timer.lap(&detail::parse_times::verify);
+
+        const auto index_size = detail::index_size<index_policy>(sizes.kvps);
+        const auto buckets = detail::index_buckets<index_policy>(sizes.kvps);
+        auto t = allocate(sizes.kvps, sizes.sections, index_size, buckets,
+            static_cast<unsigned int>(blocks.size()), sizes.chars);
+
+        auto slots = detail::resource_scratch{ m_resource }.make<std::uint32_t>(
+            detail::section_slots(sizes.sections));
+        auto section_count = detail::fill_kvp_buffer(begin, end, sizes.key_chars,
+            t.buffer, t.kvps, t.sections, detail::keep_all{}, std::span(slots));
+        m_layout = {
+            t.buffer,
+            t.kvps, sizes.kvps,
+            t.sections, section_count,
+            t.index, index_size,
+            t.seeds, buckets
+        };
+        record_blocks(blocks, 0, blocks.size(), t);
+        timer.lap(&detail::parse_times::fill);
+        build_index(t);
+        timer.lap(&detail::parse_times::index);
+    }
+
+#ifndef TCSULLIVAN_INI_CONFIG_NO_THREADS
+    // Parses text in chunks of whole blocks, one chunk per thread. Each chunk
+    // is measured and then filled into its own part of the kvp buffer and
+    // tables, as if it were the whole text. The chunks' section directories
+    // are then stitched into one by keeping only each section's first run,
+    // and the index is built over the whole kvp table, so lookups match
+    // those of a config parsed in one piece.
+    void parse_parallel(const std::pmr::vector<detail::text_block<char_type>>& blocks, std::size_t threads) {
+        struct chunk {
+            std::size_t first_block = 0;
+            std::size_t last_block = 0;
+            detail::parse_sizes sizes;
+            unsigned int key_at = 0;   // Position of its key pool in the kvp buffer
+            unsigned int value_at = 0; // Position of its value pool
+            unsigned int kvp_at = 0;
+            unsigned int section_at = 0;
+            unsigned int section_count = 0;
+            std::size_t slot_at = 0;   // Position of its section_finder table
+        };
+
+        // Group the blocks into chunks of about equal length
+        phase_timer timer(m_parse_times);
+        const auto begin = blocks.front().first;
+        const auto total = static_cast<std::size_t>(blocks.back().last - begin);
+        std::pmr::vector<chunk> chunks(m_resource);
+        for (std::size_t b = 0; b < blocks.size();) {
+            auto& c = chunks.emplace_back();
+            c.first_block = b;
+            auto goal = total / threads * chunks.size();
+            do
+                ++b;
+            while (b < blocks.size() && static_cast<std::size_t>(blocks[b].first - begin) < goal);
+            c.last_block = b;
+        }
+        auto text = [&blocks](const chunk& c) {
+            return std::pair(blocks[c.first_block].first, blocks[c.last_block - 1].last);
+        };
+        timer.lap(&detail::parse_times::split);
+
+        detail::parallel_for(chunks.size(), m_resource, [&](std::size_t i) {
+            auto [first, last] = text(chunks[i]);
+            chunks[i].sizes = detail::verify_and_size(first, last);
+        });
+        detail::parse_sizes sizes;
+        for (const auto& c : chunks) {
+            if (c.sizes.status != detail::parse_status::ok) {
+                throw parse_error(detail::parse_message(c.sizes.status),
+                    blocks[c.first_block].line + c.sizes.line);
+            }
+            sizes.chars += c.sizes.chars;
+            sizes.key_chars += c.sizes.key_chars;
+            sizes.kvps += c.sizes.kvps;
+            sizes.sections += c.sizes.sections;
+        }
+        std::size_t slot_count = 0;
+        for (unsigned int i = 0, key_at = 0, value_at = sizes.key_chars, kvp_at = 0, section_at = 0;
+            i < chunks.size(); ++i)
+        {
+            auto& c = chunks[i];
+            c.key_at = key_at;
+            c.value_at = value_at;
+            c.kvp_at = kvp_at;
+            c.section_at = section_at;
+            c.slot_at = slot_count;
+            key_at += c.sizes.key_chars;
+            value_at += c.sizes.chars - c.sizes.key_chars;
+            kvp_at += c.sizes.kvps;
+            section_at += c.sizes.sections;
+            slot_count += detail::section_slots(c.sizes.sections);
+        }
+        timer.lap(&detail::parse_times::verify);
+
+        const auto index_size = detail::index_size<index_policy>(sizes.kvps);
+        const auto buckets = detail::index_buckets<index_policy>(sizes.kvps);
+        auto t = allocate(sizes.kvps, sizes.sections, index_size, buckets,
+            static_cast<unsigned int>(blocks.size()), sizes.chars);
+
+        // The chunks' section_finder tables, allocated here as the
+        // resource need not be thread-safe
+        auto slots = detail::resource_scratch{ m_resource }.make<std::uint32_t>(slot_count);
+
+        detail::parallel_for(chunks.size(), m_resource, [&](std::size_t i) {
+            auto& c = chunks[i];
+            auto [first, last] = text(c);
+            auto kvps = t.kvps + c.kvp_at;
+            auto sections = t.sections + c.section_at;
+            c.section_count = detail::fill_kvp_buffer(first, last, c.value_at - c.key_at,
+                t.buffer + c.key_at, kvps, sections, detail::keep_all{},
+                std::span(slots).subspan(c.slot_at, detail::section_slots(c.sizes.sections)));
+
+            // Make the chunk's offsets relative to the whole buffer and table
+            for (unsigned int k = 0; k < c.sizes.kvps; ++k) {
+                kvps[k].key += c.key_at;
+                kvps[k].value += c.key_at;
+                if (kvps[k].section != detail::npos<offset_type>)
+                    kvps[k].section += c.key_at;
+            }
+            for (unsigned int s = 0; s < c.section_count; ++s) {
+                sections[s].name += c.key_at;
+                sections[s].index += c.kvp_at;
+            }
+            record_blocks(blocks, c.first_block, c.last_block, t, c.kvp_at);
+        });
+
+        // Keep each section's first run, which may continue across chunks
+        std::pmr::unordered_set<view_type> seen(m_resource);
+        unsigned int section_count = 0;
+        for (const auto& c : chunks) {
+            for (unsigned int s = 0; s < c.section_count; ++s) {
+                auto run = t.sections[c.section_at + s];
+                auto name = view_type(t.buffer + run.name);
+                if (section_count > 0) {
+                    auto& prev = t.sections[section_count - 1];
+                    if (prev.index + prev.count == run.index && view_type(t.buffer + prev.name) == name) {
+                        prev.count += run.count;
+                        continue;
+                    }
+                }
+                if (seen.insert(name).second)
+                    t.sections[section_count++] = run;
+            }
+        }
+
+        m_layout = {
+            t.buffer,
+            t.kvps, sizes.kvps,
+            t.sections, section_count,
+            t.index, index_size,
+            t.seeds, buckets
+        };
+        timer.lap(&detail::parse_times::fill);
+        build_index(t);
+        timer.lap(&detail::parse_times::index);
+    }
+#endif
+
+    // Stores the records of blocks [first, last), whose kvps start at the
+    // given kvp table position
+    void record_blocks(const std::pmr::vector<detail::text_block<char_type>>& blocks,
+        std::size_t first, std::size_t last, const tables& t, unsigned int kvp_at = 0) const noexcept
+    {
+        auto kvp = t.kvps + kvp_at;
+        for (auto i = first; i < last; ++i) {
+            const auto& b = blocks[i];
+            auto h = detail::key_hash_step(detail::fnv1a_basis, b.name, b.name_end);
+            for (auto end = kvp + b.kvps; kvp != end; ++kvp)
+                h = detail::key_hash_step(h, t.buffer + kvp->key, t.buffer + kvp->key + kvp->key_size);
+            t.blocks[i] = { b.hash, h, static_cast<std::uint32_t>(b.last - b.first), b.kvps };
+        }
+    }
+
+    void build_index(const tables& t) {
+        if constexpr (layout_type::use_hash) {
+            detail::build_hash_or_sorted_index(m_layout, t.index, t.seeds, detail::resource_scratch{ m_resource });
+        } else if constexpr (layout_type::use_sorted) {
+            m_layout.index_size = detail::build_sorted_index(m_layout, t.index);
+        }
+    }
+
+    // Parses text that is an edit of the previous config's. If only values
+    // changed, the unchanged blocks' values and all keys, tables, and the
+    // index are copied, and only the changed blocks are tokenized.
+    // Otherwise, this falls back to parse().
+    void reparse(const char_type *begin, const char_type *end, const basic_runtime_config& previous) {
+        const auto& prev = previous.m_layout;
+        phase_timer timer(m_parse_times);
+        const auto blocks = detail::split_blocks(begin, end, m_resource);
+        timer.lap(&detail::parse_times::split);
+        if (prev.kvp_count == 0 || blocks.size() != previous.m_block_count)
+            return parse(begin, end);
+
+        // The chars of each previous block's values (which are consecutive)
+        auto value_range = [&prev](unsigned int first, unsigned int count) {
+            if (count == 0)
+                return std::pair<unsigned int, unsigned int>(0, 0);
+            const auto& last = prev.kvps[first + count - 1];
+            auto start = prev.kvps[first].value;
+            return std::pair<unsigned int, unsigned int>(start, last.value + last.value_size + 1 - start);
+        };
+
+        // Tokenize the changed blocks, giving up if any of their keys changed
+        struct value_span {
+            const char_type *first;
+            const char_type *last;
+        };
+        std::pmr::vector<value_span> values(m_resource);
+        std::pmr::vector<std::size_t> changed(blocks.size(), ~std::size_t(0), m_resource);
+        unsigned int value_chars = 0;
+        for (unsigned int i = 0, kvp = 0; i < blocks.size(); kvp += blocks[i++].kvps) {
+            const auto& b = blocks[i];
+            const auto& record = previous.m_blocks[i];
+            if (b.kvps != record.kvps)
+                return parse(begin, end);
+            if (b.hash == record.text_hash && static_cast<std::uint32_t>(b.last - b.first) == record.text_size) {
+                value_chars += value_range(kvp, b.kvps).second;
+                continue;
+            }
+
+            changed[i] = values.size();
+            auto h = detail::key_hash_step(detail::fnv1a_basis, b.name, b.name_end);
+            auto sizes = detail::tokenize(b.first, b.last, [](auto, auto) {},
+                [&](auto key, auto key_end, auto value, auto value_end) {
+                    h = detail::key_hash_step(h, key, key_end);
+                    values.push_back({ value, value_end });
+                    value_chars += static_cast<unsigned int>(value_end - value) + 1;
+                });
+            if (sizes.status != detail::parse_status::ok)
+                throw parse_error(detail::parse_message(sizes.status), b.line + sizes.line);
+            if (h != record.key_hash)
+                return parse(begin, end);
+        }
+        timer.lap(&detail::parse_times::verify);
+
+        const auto key_chars = prev.kvps[0].value;
+        auto t = allocate(prev.kvp_count, prev.section_count, prev.index_size, prev.bucket_count,
+            previous.m_block_count, key_chars + value_chars);
+        std::copy_n(prev.buffer, key_chars, t.buffer);
+        std::copy_n(prev.kvps, prev.kvp_count, t.kvps);
+        std::copy_n(prev.sections, prev.section_count, t.sections);
+        std::copy_n(prev.index, prev.index_size, t.index);
+        std::copy_n(prev.seeds, prev.bucket_count, t.seeds);
+        std::copy_n(previous.m_blocks, previous.m_block_count, t.blocks);
+
+        // Lay out the value pool again, block by block
+        auto vptr = t.buffer + key_chars;
+        for (unsigned int i = 0, kvp = 0; i < blocks.size(); kvp += blocks[i++].kvps) {
+            const auto& b = blocks[i];
+            if (changed[i] == ~std::size_t(0)) {
+                auto [start, size] = value_range(kvp, b.kvps);
+                auto delta = static_cast<offset_type>(vptr - t.buffer) - start;
+                vptr = std::copy_n(prev.buffer + start, size, vptr);
+                for (unsigned int k = kvp; k < kvp + b.kvps; ++k)
+                    t.kvps[k].value += delta;
+            } else {
+                for (unsigned int k = kvp, j = 0; j < b.kvps; ++k, ++j) {
+                    const auto& v = values[changed[i] + j];
+                    t.kvps[k].value = static_cast<offset_type>(vptr - t.buffer);
+                    t.kvps[k].value_size = static_cast<offset_type>(v.last - v.first);
+                    vptr = std::copy(v.first, v.last, vptr);
+                    *vptr++ = '\0';
+                }
+                t.blocks[i].text_hash = b.hash;
+                t.blocks[i].text_size = static_cast<std::uint32_t>(b.last - b.first);
+            }
+        }
+
+        m_layout = {
+            t.buffer,
+            t.kvps, prev.kvp_count,
+            t.sections, prev.section_count,
+            t.index, prev.index_size,
+            t.seeds, prev.bucket_count
+        };
+        timer.lap(&detail::parse_times::fill);
+    }
+
+    static std::pmr::string read_file(const char *path, std::pmr::memory_resource *resource) {
+        std::unique_ptr<std::FILE, int (*)(std::FILE *)> file(std::fopen(path, "rb"), std::fclose);
+        if (!file)
+            throw std::runtime_error(std::string("Could not open ") + path);
+
+        std::pmr::string text(resource);
+        char chunk[4096];
+        for (std::size_t n; (n = std::fread(chunk, 1, sizeof(chunk), file.get())) > 0;)
+            text.append(chunk, n);
+        if (std::ferror(file.get()))
+            throw std::runtime_error(std::string("Could not read ") + path);
+        return text;
+    }
+
+    // Implements tryget_many()
+    std::size_t many(const view_type *sec, std::span<const char_type *const> keys,
+        std::span<const char_type *> values) const
+    {
+        detail::check_batch(keys.size(), values.size());
+        std::size_t found = 0;
+        detail::find_many(m_layout, sec, keys.data(), keys.size(),
+            [&](std::size_t i, unsigned int k) {
+                values[i] = k != layout_type::no_kvp ?
+                    m_layout.buffer + m_layout.kvps[k].value : nullptr;
+                found += k != layout_type::no_kvp;
+                if constexpr (use_stats) {
+                    if (m_stats != nullptr)
+                        detail::record_batched(*m_stats, sec, view_type(keys[i]), k);
+                }
+            });
+        return found;
+    }
+
+    // Parses text measured by config_loader as it arrived
+    template<typename Config>
+    friend class config_loader;
+    basic_runtime_config(std::basic_string_view<char_type> text, const detail::parse_sizes& measured,
+        std::pmr::memory_resource *resource)
+        : m_resource(resource)
+    {
+        parse(text.data(), text.data() + text.size(), &measured);
+        start_stats();
+    }
+
+public:
+    // Stores a key-value pair, including a section identifier
+    using kvp = detail::kvp<char_type>;
+    using iterator = detail::iterator<char_type, detail::kvp_offsets<offset_type>>;
+    using section_view = detail::section_view<iterator>;
+    // A section directory entry, as returned by find_section()
+    using section_entry = detail::section_entry<offset_type>;
+
+    /**
+     * Constructs an empty config.
+     */
+    basic_runtime_config() noexcept = default;
+
+    /**
+     * Parses the given INI text, throwing parse_error if it is invalid.
+     * The text is copied, so it need not outlive the config.
+     * The config's memory (a single block) and any scratch memory used while
+     * parsing come from the given resource, which must outlive the config.
+     * A std::pmr::monotonic_buffer_resource makes a simple arena.
+     * Large texts are parsed on several threads, but the resource is only
+     * used by the calling thread.
+     */
+    explicit basic_runtime_config(std::basic_string_view<char_type> text,
+        std::pmr::memory_resource *resource = std::pmr::get_default_resource())
+        : m_resource(resource)
+    {
+        parse(text.data(), text.data() + text.size());
+        start_stats();
+    }
+
+    /**
+     * Parses INI text that is an edit of the previous config's text, as on
+     * a reload. Blocks of text (a section header and its lines) that did
+     * not change are not tokenized again; if no keys were added, removed,
+     * or renamed, the keys, tables, and lookup index are copied rather than
+     * rebuilt. The result is the same as parsing the text from scratch.
+     * Memory comes from the given resource, or if nullptr, from the
+     * previous config's.
+     */
+    basic_runtime_config(std::basic_string_view<char_type> text, const basic_runtime_config& previous,
+        std::pmr::memory_resource *resource = nullptr)
+        : m_resource(resource != nullptr ? resource : previous.m_resource)
+    {
+        reparse(text.data(), text.data() + text.size(), previous);
+        start_stats();
+    }
+
+    /**
+     * Reads and parses the given INI file. Throws std::runtime_error if the
+     * file cannot be read, or parse_error if it is invalid.
+     */
+    static basic_runtime_config from_file(const char *path,
+        std::pmr::memory_resource *resource = std::pmr::get_default_resource())
+        requires(std::same_as<char_type, char>)
+    {
+        return basic_runtime_config(std::string_view(read_file(path, resource)), resource);
+    }
+    /**
+     * Reads and parses the given INI file, reusing what it can of the
+     * previous config as the constructor above does.
+     */
+    static basic_runtime_config from_file(const char *path, const basic_runtime_config& previous,
+        std::pmr::memory_resource *resource = nullptr)
+        requires(std::same_as<char_type, char>)
+    {
+        auto text = read_file(path, resource != nullptr ? resource : previous.m_resource);
+        return basic_runtime_config(std::string_view(text), previous, resource);
+    }
+
+    basic_runtime_config(basic_runtime_config&& other) noexcept
+        : m_resource(other.m_resource),
+          m_storage(std::move(other.m_storage)),
+          m_layout(std::exchange(other.m_layout, detail::empty_layout<layout_type>())),
+          m_blocks(std::exchange(other.m_blocks, nullptr)),
+          m_block_count(std::exchange(other.m_block_count, 0)),
+          m_stats(std::move(other.m_stats)),
+          m_parse_times(other.m_parse_times) {}
+    basic_runtime_config& operator=(basic_runtime_config&& other) noexcept {
+        m_resource = other.m_resource;
+        m_storage = std::move(other.m_storage);
+        m_layout = std::exchange(other.m_layout, detail::empty_layout<layout_type>());
+        m_blocks = std::exchange(other.m_blocks, nullptr);
+        m_block_count = std::exchange(other.m_block_count, 0);
+        m_stats = std::move(other.m_stats);
+        m_parse_times = other.m_parse_times;
+        return *this;
+    }
+
+    /**
+     * Returns the config as a precompiled blob for basic_blob_config,
+     * allocated from the config's memory resource. Throws
+     * std::runtime_error if the blob would exceed 4 GiB.
+     */
+    std::pmr::vector<unsigned char> blob() const {
+        auto plan = detail::plan_blob<char_type>(m_layout.kvp_count, m_layout.section_count,
+            m_layout.index_size, m_layout.bucket_count, m_layout.buffer_size());
+        if (plan.size > detail::npos<std::uint32_t>)
+            throw std::runtime_error("Config is too large for a blob!");
+        std::pmr::vector<unsigned char> out(plan.size, m_resource);
+        detail::write_blob(m_layout, plan, out.data());
+        return out;
+    }
+
+    /**
+     * Returns the memory resource that the config was allocated from.
+     */
+    std::pmr::memory_resource *resource() const noexcept {
+        return m_resource;
+    }
+
+    /**
+     * Returns the number of key-value pairs.
+     */
+    unsigned int size() const noexcept {
+        return m_layout.kvp_count;
+    }
+
+    auto begin() const noexcept {
+        return m_layout.begin();
+    }
+    auto end() const noexcept {
+        return m_layout.end();
+    }
+    auto cbegin() const noexcept {
+        return begin();
+    }
+    auto cend() const noexcept {
+        return end();
+    }
+
+    /**
+     * Section lookup and iteration, as with ini_config.
+     */
+    const section_entry *find_section(const char_type *section) const noexcept {
+        return m_layout.find_section(section);
+    }
+    const section_entry *find_section(view_type section) const noexcept {
+        return m_layout.find_section(section);
+    }
+    auto begin(const section_entry& section) const noexcept {
+        return m_layout.begin(section);
+    }
+    auto begin(const char_type *section) const noexcept {
+        auto sec = find_section(section);
+        return sec != nullptr ? begin(*sec) : end();
+    }
+    auto begin(view_type section) const noexcept {
+        auto sec = find_section(section);
+        return sec != nullptr ? begin(*sec) : end();
+    }
+    auto end(const section_entry& section) const noexcept {
+        return m_layout.end(section);
+    }
+    auto end(const char_type *section) const noexcept {
+        auto sec = find_section(section);
+        return sec != nullptr ? end(*sec) : end();
+    }
+    auto end(view_type section) const noexcept {
+        auto sec = find_section(section);
+        return sec != nullptr ? end(*sec) : end();
+    }
+    auto section(const section_entry& s) const noexcept {
+        return section_view(begin(s), end(s), s.count);
+    }
+    auto section(const char_type *s) const noexcept {
+        return m_layout.section(s);
+    }
+    auto section(view_type s) const noexcept {
+        return m_layout.section(s);
+    }
+
+    /**
+     * With the lookup_stats option, returns the lookups counted since the
+     * config was parsed as JSON, as with ini_config's stats_json(), followed
+     * by the time taken by each phase of the parse.
+     */
+    std::string stats_json() const requires(use_stats) {
+        if (m_stats == nullptr)
+            return detail::lookup_recorder(0).json(m_layout, &m_parse_times);
+        return m_stats->json(m_layout, &m_parse_times);
+    }
+};
+
+using runtime_config = basic_runtime_config<char>;
+
+/**
+ * Builds a run-time config from text that arrives in chunks (e.g. from
+ * asynchronous reads of a network filesystem), measuring each chunk's whole
+ * lines as it arrives. Invalid text throws parse_error as soon as its line
+ * is complete, and finish() is left with filling the config and building
+ * its index. Call feed() from I/O completion callbacks, or see
+ * load_async() for a coroutine. Config is a basic_runtime_config.
+ */
+template<typename Config = runtime_config>
+class config_loader
+{
+public:
+    using config_type = Config;
+    using char_type = typename Config::char_type;
+    using view_type = std::basic_string_view<char_type>;
+
+private:
+    std::pmr::memory_resource *m_resource;
+    std::pmr::basic_string<char_type> m_text;
+    std::size_t m_measured = 0; // Length of the text's measured lines
+    unsigned int m_line = 0;    // Lines measured so far
+    detail::parse_sizes m_sizes;
+
+    // Measures the text up to 'last', which ends a line or the text
+    void measure(std::size_t last) {
+        auto first = m_text.data() + m_measured;
+        auto end = m_text.data() + last;
+        auto sizes = detail::verify_and_size(first, end);
+        if (sizes.status != detail::parse_status::ok)
+            throw parse_error(detail::parse_message(sizes.status), m_line + sizes.line);
+        m_sizes.chars += sizes.chars;
+        m_sizes.key_chars += sizes.key_chars;
+        m_sizes.kvps += sizes.kvps;
+        m_sizes.sections += sizes.sections;
+        m_line += static_cast<unsigned int>(std::count_if(first, end, detail::iseol<char_type>));
+        m_measured = last;
+    }
+
+public:
+    /**
+     * Starts a config, to be allocated (as is the text while loading) from
+     * the given resource.
+     */
+    explicit config_loader(std::pmr::memory_resource *resource = std::pmr::get_default_resource())
+        : m_resource(resource), m_text(resource) {}
+
+    /**
+     * Adds the next chunk of text, measuring its whole lines. The rest of the
+     * chunk is kept until a later chunk ends its line.
+     */
+    void feed(view_type chunk) {
+        m_text.append(chunk);
+        auto last = m_text.size();
+        while (last > m_measured && !detail::iseol(m_text[last - 1]))
+            --last;
+        if (last > m_measured)
+            measure(last);
+    }
+
+    /**
+     * Measures any last line, and builds the config from the whole text.
+     * The loader is left empty.
+     */
+    config_type finish() {
+        if (m_text.size() > m_measured)
+            measure(m_text.size());
+        auto text = std::exchange(m_text, std::pmr::basic_string<char_type>(m_resource));
+        auto sizes = std::exchange(m_sizes, {});
+        m_measured = 0;
+        m_line = 0;
+        return config_type(view_type(text), sizes, m_resource);
+    }
+};
+
+#ifdef TCSULLIVAN_INI_CONFIG_HAS_COROUTINES
+/**
+ * A coroutine producing a T, as returned by load_async(). It does not start
+ * until awaited (or until get() is called), and then runs on whichever
+ * thread resumes it, e.g. an executor completing its reads. Awaiting it
+ * gives its result or rethrows its exception.
+ */
+template<typename T>
+class task
+{
+public:
+    struct promise_type;
+    using handle_type = std::coroutine_handle<promise_type>;
+
+private:
+    // Lets get() sleep until the task is done on another thread
+    struct waiter {
+        std::mutex mutex;
+        std::condition_variable done_cv;
+        bool done = false;
+    };
+
+    handle_type m_handle;
+
+    explicit task(handle_type handle) noexcept
+        : m_handle(handle) {}
+
+    T result() {
+        auto& p = m_handle.promise();
+        if (p.error)
+            std::rethrow_exception(p.error);
+        return std::move(*p.value);
+    }
+
+public:
+    struct promise_type {
+        std::optional<T> value;
+        std::exception_ptr error;
+        std::coroutine_handle<> continuation = std::noop_coroutine();
+        waiter *sleeper = nullptr;
+
+        task get_return_object() noexcept {
+            return task(handle_type::from_promise(*this));
+        }
+        std::suspend_always initial_suspend() noexcept {
+            return {};
+        }
+        auto final_suspend() noexcept {
+            // Wakes whoever waits on the task, touching nothing of the
+            // frame after, as the waiter may then destroy it
+            struct wake {
+                bool await_ready() noexcept {
+                    return false;
+                }
+                std::coroutine_handle<> await_suspend(handle_type h) noexcept {
+                    auto next = h.promise().continuation;
+                    if (auto w = h.promise().sleeper; w != nullptr) {
+                        std::lock_guard lock(w->mutex);
+                        w->done = true;
+                        w->done_cv.notify_all();
+                    }
+                    return next;
+                }
+                void await_resume() noexcept {}
+            };
+            return wake{};
+        }
+        template<typename U>
+        void return_value(U&& v) {
+            value.emplace(std::forward<U>(v));
+        }
+        void unhandled_exception() noexcept {
+            error = std::current_exception();
+        }
+    };
+
+    task(task&& other) noexcept
+        : m_handle(std::exchange(other.m_handle, nullptr)) {}
+    task& operator=(task&& other) noexcept {
+        if (this != &other) {
+            if (m_handle)
+                m_handle.destroy();
+            m_handle = std::exchange(other.m_handle, nullptr);
+        }
+        return *this;
+    }
+    ~task() {
+        if (m_handle)
+            m_handle.destroy();
+    }
+
+    auto operator co_await() && noexcept {
+        struct awaiter {
+            task& t;
+
+            bool await_ready() noexcept {
+                return false;
+            }
+            std::coroutine_handle<> await_suspend(std::coroutine_handle<> h) noexcept {
+                t.m_handle.promise().continuation = h;
+                return t.m_handle;
+            }
+            T await_resume() {
+                return t.result();
+            }
+        };
+        return awaiter{ *this };
+    }
+
+    /**
+     * Runs the task, blocking until it is done (if it suspends, until
+     * another thread has resumed it to completion), and returns its result
+     * or rethrows its exception.
+     */
+    T get() && {
+        waiter w;
+        m_handle.promise().sleeper = &w;
+        m_handle.resume();
+        std::unique_lock lock(w.mutex);
+        w.done_cv.wait(lock, [&w] { return w.done; });
+        return result();
+    }
+};
+
+/**
+ * Loads a run-time config as a coroutine, measuring each chunk of text while
+ * waiting for the next. co_await read() must give the next chunk (as a
+ * string, or anything else convertible to a string view), or an empty one
+ * at the end, and may suspend on the caller's executor. The config and the text are
+ * allocated from the given resource. Several loads awaited together (e.g.
+ * through an executor's when_all) overlap one's reads with another's parsing:
+ *
+ *   auto config = co_await ini_config::load_async([&file] { return file.async_read(); });
+ */
+template<typename Config = runtime_config, typename ReadFn>
+task<Config> load_async(ReadFn read, std::pmr::memory_resource *resource = std::pmr::get_default_resource()) {
+    config_loader<Config> loader(resource);
+    for (;;) {
+        // A chunk may be a temporary string, so it is kept until it is fed
+        auto&& data = co_await read();
+        typename config_loader<Config>::view_type chunk(data);
+        if (chunk.empty())
+            break;
+        loader.feed(chunk);
+    }
+    co_return loader.finish();
+}
+#endif // TCSULLIVAN_INI_CONFIG_HAS_COROUTINES
+
+#ifdef TCSULLIVAN_INI_CONFIG_HAS_MMAP
+/**
+ * A run-time config that memory-maps its file instead of copying it.
+ * Only offset/length tables and the lookup index are built, so keys and
+ * values are returned as string_views into the mapping. These remain valid
+ * for the config's lifetime, provided that the file is not modified.
+ * Accepts the same index policy options as ini_config.
+ */
+template<typename... Options>
+class basic_mapped_config
+    : public detail::lookup_surface<basic_mapped_config<Options...>, char, false>
+{
+public:
+    using char_type = char;
+    using view_type = std::string_view;
+
+private:
+    friend detail::lookup_surface<basic_mapped_config, char, false>;
+
+    using index_policy = typename detail::find_option<detail::is_index_policy,
+        perfect_hash_index, Options...>::type;
+    using layout_type = detail::span_layout<char_type, index_policy>;
+
+    detail::mapped_file m_file;
+    // The tables and index share a single allocation
+    std::unique_ptr<std::byte[]> m_storage;
+    layout_type m_layout = detail::empty_layout<layout_type>();
+
+    explicit basic_mapped_config(detail::mapped_file file)
+        : m_file(std::move(file))
+    {
+        auto begin = m_file.data();
+        auto end = begin + m_file.size();
+        if (m_file.size() >= detail::npos<std::uint32_t>)
+            throw parse_error("File is too large!", 0);
+
+        auto sizes = detail::verify_and_size(begin, end);
+        if (sizes.status != detail::parse_status::ok)
+            throw parse_error(detail::parse_message(sizes.status), sizes.line);
+
+        const auto index_size = detail::index_size<index_policy>(sizes.kvps);
+        const auto buckets = detail::index_buckets<index_policy>(sizes.kvps);
+
+        detail::block_plan plan;
+        auto kvps_at = plan.add<detail::span_offsets>(sizes.kvps);
+        auto sections_at = plan.add<section_entry>(sizes.sections);
+        auto index_at = plan.add<std::uint32_t>(index_size);
+        auto seeds_at = plan.add<std::uint16_t>(buckets);
+
+        m_storage = std::make_unique<std::byte[]>(plan.size());
+        auto storage = m_storage.get();
+        auto kvps = reinterpret_cast<detail::span_offsets *>(storage + kvps_at);
+        auto sections = reinterpret_cast<section_entry *>(storage + sections_at);
+        auto index = reinterpret_cast<std::uint32_t *>(storage + index_at);
+        auto seeds = reinterpret_cast<std::uint16_t *>(storage + seeds_at);
+
+        auto slots = detail::resource_scratch{}.make<std::uint32_t>(detail::section_slots(sizes.sections));
+        auto section_count = detail::fill_span_tables(begin, end, kvps, sections, std::span(slots));
+        m_layout = {
+            begin,
+            kvps, sizes.kvps,
+            sections, section_count,
+            index, index_size,
+            seeds, buckets
+        };
+
+        if constexpr (layout_type::use_hash) {
+            detail::build_hash_or_sorted_index(m_layout, index, seeds, detail::resource_scratch{});
+        } else if constexpr (layout_type::use_sorted) {
+            m_layout.index_size = detail::build_sorted_index(m_layout, index);
+        }
+    }
+
+    // Returns the value of the given kvp, or an empty view for no_kvp
+    view_type value_of(unsigned int i) const noexcept {
+        if (i == layout_type::no_kvp)
+            return view_type();
+        const auto& e = m_layout.kvps[i];
+        return view_type(m_layout.text + e.value, e.value_size);
+    }
+    detail::found_value<char_type> find_value(const view_type *sec,
+        const basic_key<char_type>& key) const noexcept
+    {
+        auto i = m_layout.find_kvp(sec, key);
+        return { value_of(i), i };
+    }
+
+    // Implements tryget_many()
+    std::size_t many(const view_type *sec, std::span<const view_type> keys,
+        std::span<view_type> values) const
+    {
+        detail::check_batch(keys.size(), values.size());
+        std::size_t found = 0;
+        detail::find_many(m_layout, sec, keys.data(), keys.size(),
+            [&](std::size_t i, unsigned int k) {
+                values[i] = value_of(k);
+                found += k != layout_type::no_kvp;
+            });
+        return found;
+    }
+
+public:
+    // Stores a key-value pair as string_views, including a section identifier
+    using kvp = detail::span_kvp<char_type>;
+    using iterator = detail::span_iterator<char_type>;
+    using section_view = detail::section_view<iterator>;
+    // A section directory entry, as returned by find_section()
+    using section_entry = detail::span_section;
+
+    /**
+     * Constructs an empty config.
+     */
+    basic_mapped_config() noexcept = default;
+
+    /**
+     * Maps and indexes the given INI file. Throws std::runtime_error if the
+     * file cannot be mapped, or parse_error if it is invalid.
+     */
+    static basic_mapped_config from_file(const char *path) {
+        return basic_mapped_config(detail::mapped_file(path));
+    }
+
+    basic_mapped_config(basic_mapped_config&& other) noexcept
+        : m_file(std::move(other.m_file)),
+          m_storage(std::move(other.m_storage)),
+          m_layout(std::exchange(other.m_layout, detail::empty_layout<layout_type>())) {}
+    basic_mapped_config& operator=(basic_mapped_config&& other) noexcept {
+        m_file = std::move(other.m_file);
+        m_storage = std::move(other.m_storage);
+        m_layout = std::exchange(other.m_layout, detail::empty_layout<layout_type>());
+        return *this;
+    }
+
+    /**
+     * Returns the number of key-value pairs.
+     */
+    unsigned int size() const noexcept {
+        return m_layout.kvp_count;
+    }
+
+    auto begin() const noexcept {
+        return m_layout.begin();
+    }
+    auto end() const noexcept {
+        return m_layout.end();
+    }
+    auto cbegin() const noexcept {
+        return begin();
+    }
+    auto cend() const noexcept {
+        return end();
+    }
+
+    /**
+     * Section lookup and iteration, as with ini_config.
+     */
+    const section_entry *find_section(view_type section) const noexcept {
+        return m_layout.find_section(section);
+    }
+    auto begin(const section_entry& section) const noexcept {
+        return m_layout.begin(section.index);
+    }
+    auto begin(view_type section) const noexcept {
+        auto sec = find_section(section);
+        return sec != nullptr ? begin(*sec) : end();
+    }
+    auto end(const section_entry& section) const noexcept {
+        return m_layout.begin(section.index + section.count);
+    }
+    auto end(view_type section) const noexcept {
+        auto sec = find_section(section);
+        return sec != nullptr ? end(*sec) : end();
+    }
+    auto section(const section_entry& s) const noexcept {
+        return section_view(begin(s), end(s), s.count);
+    }
+    auto section(view_type s) const noexcept {
+        return m_layout.section(s);
+    }
+};
+
+using mapped_config = basic_mapped_config<>;
+#endif // TCSULLIVAN_INI_CONFIG_HAS_MMAP
+
+/**
+ * A config loaded from a precompiled blob, as written by ini_config's or
+ * basic_runtime_config's blob(). The blob is used in place: loading checks
+ * its header and that every offset and index entry stays within its array,
+ * and lookups go straight to its tables, index, and value cache (so typed
+ * lookups do not parse values either). Offers the same run-time interface
+ * as basic_runtime_config, and
+ * must be given the char type and index policy that the blob was built with.
+ */
+template<typename CharT = char, typename... Options>
+class basic_blob_config
+    : public detail::lookup_surface<basic_blob_config<CharT, Options...>, CharT>
+{
+public:
+    using char_type = CharT;
+    using view_type = std::basic_string_view<char_type>;
+
+private:
+    friend detail::lookup_surface<basic_blob_config, CharT>;
+
+    using offset_type = std::uint32_t;
+    using index_policy = typename detail::find_option<detail::is_index_policy,
+        perfect_hash_index, Options...>::type;
+    using layout_type = detail::layout<char_type, offset_type, std::uint32_t, index_policy>;
+
+#ifdef TCSULLIVAN_INI_CONFIG_HAS_MMAP
+    detail::mapped_file m_file;
+#endif
+    layout_type m_layout = detail::empty_layout<layout_type>();
+    const detail::blob_number *m_cache = nullptr;
+
+    // Checks the blob's header and points the layout into the blob
+    void load(const unsigned char *data, std::size_t size) {
+        detail::blob_header h;
+        if (size < sizeof(h))
+            throw std::runtime_error("Not a config blob!");
+        std::memcpy(&h, data, sizeof(h));
+        if (h.magic != detail::blob_magic)
+            throw std::runtime_error("Not a config blob, or written with another byte order!");
+        if (h.version != detail::blob_version)
+            throw std::runtime_error("Unsupported config blob version!");
+        if (h.char_size != sizeof(char_type) || h.index_kind != detail::blob_index_kind<layout_type>())
+            throw std::runtime_error("Config blob was written for another char type or index policy!");
+        if (reinterpret_cast<std::uintptr_t>(data) % alignof(std::uint64_t) != 0)
+            throw std::runtime_error("Config blob is misaligned!");
+
+        auto fits = [&h](std::uint32_t at, std::uint64_t bytes) {
+            return at % 8 == 0 && at + bytes <= h.size;
+        };
+        if (h.size > size || h.chars == 0 ||
+            !fits(h.kvps_at, std::uint64_t(h.kvp_count) * sizeof(detail::kvp_offsets<offset_type>)) ||
+            !fits(h.sections_at, std::uint64_t(h.section_count) * sizeof(section_entry)) ||
+            !fits(h.index_at, std::uint64_t(h.index_size) * sizeof(std::uint32_t)) ||
+            !fits(h.seeds_at, std::uint64_t(h.bucket_count) * sizeof(std::uint16_t)) ||
+            !fits(h.cache_at, std::uint64_t(h.kvp_count) * sizeof(detail::blob_number)) ||
+            !fits(h.buffer_at, std::uint64_t(h.chars) * sizeof(char_type)))
+        {
+            throw std::runtime_error("Config blob is truncated or corrupt!");
+        }
+
+        auto buffer = reinterpret_cast<const char_type *>(data + h.buffer_at);
+        auto kvps = reinterpret_cast<const detail::kvp_offsets<offset_type> *>(data + h.kvps_at);
+        auto sections = reinterpret_cast<const section_entry *>(data + h.sections_at);
+        auto index = reinterpret_cast<const std::uint32_t *>(data + h.index_at);
+
+        // Every string must end within the kvp buffer (whose last char is
+        // checked to be a null), and every kvp table position within the
+        // kvp table, so that no lookup or iteration can leave the blob
+        auto within = [&h](std::uint64_t at, std::uint64_t length) {
+            return at + length < h.chars;
+        };
+        bool valid = buffer[h.chars - 1] == '\0' && (h.bucket_count == 0 || h.index_size != 0);
+        for (std::uint32_t i = 0; valid && i < h.kvp_count; ++i) {
+            const auto& k = kvps[i];
+            valid = within(k.key, k.key_size) && within(k.value, k.value_size) &&
+                (k.section == detail::npos<offset_type> || within(k.section, 0));
+        }
+        for (std::uint32_t i = 0; valid && i < h.section_count; ++i) {
+            const auto& sec = sections[i];
+            valid = within(sec.name, 0) && std::uint64_t(sec.index) + sec.count <= h.kvp_count;
+        }
+        for (std::uint32_t i = 0; valid && i < h.index_size; ++i) {
+            valid = index[i] == layout_type::index_empty ||
+                (index[i] & ~layout_type::index_global) < h.kvp_count;
+        }
+        if (!valid)
+            throw std::runtime_error("Config blob is truncated or corrupt!");
+
+        m_layout = {
+            buffer,
+            kvps, h.kvp_count,
+            sections, h.section_count,
+            index, h.index_size,
+            reinterpret_cast<const std::uint16_t *>(data + h.seeds_at), h.bucket_count
+        };
+        m_cache = reinterpret_cast<const detail::blob_number *>(data + h.cache_at);
+    }
+
+    // Lookups for detail::lookup_surface; typed lookups read the value cache
+    detail::found_value<char_type> find_value(const view_type *sec,
+        const basic_key<char_type>& key) const noexcept
+    {
+        auto i = m_layout.find_kvp(sec, key);
+        return { m_layout.value_of(i), i };
+    }
+    template<typename T>
+    detail::number<T> convert_value(const detail::found_value<char_type>& v) const noexcept {
+        return v.found() ? detail::unpack_number<T>(m_cache[v.kvp]) : detail::number<T>{};
+    }
+
+    // Implements tryget_many()
+    std::size_t many(const view_type *sec, std::span<const char_type *const> keys,
+        std::span<const char_type *> values) const
+    {
+        detail::check_batch(keys.size(), values.size());
+        std::size_t found = 0;
+        detail::find_many(m_layout, sec, keys.data(), keys.size(),
+            [&](std::size_t i, unsigned int k) {
+                values[i] = k != layout_type::no_kvp ?
+                    m_layout.buffer + m_layout.kvps[k].value : nullptr;
+                found += k != layout_type::no_kvp;
+            });
+        return found;
+    }
+
+public:
+    // Stores a key-value pair, including a section identifier
+    using kvp = detail::kvp<char_type>;
+    using iterator = detail::iterator<char_type, detail::kvp_offsets<offset_type>>;
+    using section_view = detail::section_view<iterator>;
+    // A section directory entry, as returned by find_section()
+    using section_entry = detail::section_entry<offset_type>;
+
+    /**
+     * Constructs an empty config.
+     */
+    basic_blob_config() noexcept = default;
+
+    /**
+     * Uses the given blob in place, throwing std::runtime_error if it is not
+     * a valid blob for this config type. The blob must be aligned to 8 bytes
+     * and outlive the config.
+     */
+    explicit basic_blob_config(std::span<const unsigned char> blob) {
+        load(blob.data(), blob.size());
+    }
+
+#ifdef TCSULLIVAN_INI_CONFIG_HAS_MMAP
+    /**
+     * Memory-maps the given blob file and uses it in place. Throws
+     * std::runtime_error if the file cannot be mapped or is not a valid blob.
+     */
+    static basic_blob_config from_file(const char *path) {
+        basic_blob_config config;
+        config.m_file = detail::mapped_file(path);
+        config.load(reinterpret_cast<const unsigned char *>(config.m_file.data()), config.m_file.size());
+        return config;
+    }
+#endif
+
+    basic_blob_config(basic_blob_config&& other) noexcept
+        :
+#ifdef TCSULLIVAN_INI_CONFIG_HAS_MMAP
+          m_file(std::move(other.m_file)),
+#endif
+          m_layout(std::exchange(other.m_layout, detail::empty_layout<layout_type>())),
+          m_cache(std::exchange(other.m_cache, nullptr)) {}
+    basic_blob_config& operator=(basic_blob_config&& other) noexcept {
+#ifdef TCSULLIVAN_INI_CONFIG_HAS_MMAP
+        m_file = std::move(other.m_file);
+#endif
+        m_layout = std::exchange(other.m_layout, detail::empty_layout<layout_type>());
+        m_cache = std::exchange(other.m_cache, nullptr);
+        return *this;
+    }
+
+    /**
+     * Returns the number of key-value pairs.
+     */
+    unsigned int size() const noexcept {
+        return m_layout.kvp_count;
+    }
+
+    auto begin() const noexcept {
+        return m_layout.begin();
+    }
+    auto end() const noexcept {
+        return m_layout.end();
+    }
+    auto cbegin() const noexcept {
+        return begin();
+    }
+    auto cend() const noexcept {
+        return end();
+    }
+
+    /**
+     * Section lookup and iteration, as with ini_config.
+     */
+    const section_entry *find_section(const char_type *section) const noexcept {
+        return m_layout.find_section(section);
+    }
+    const section_entry *find_section(view_type section) const noexcept {
+        return m_layout.find_section(section);
+    }
+    auto begin(const section_entry& section) const noexcept {
+        return m_layout.begin(section);
+    }
+    auto begin(const char_type *section) const noexcept {
+        auto sec = find_section(section);
+        return sec != nullptr ? begin(*sec) : end();
+    }
+    auto begin(view_type section) const noexcept {
+        auto sec = find_section(section);
+        return sec != nullptr ? begin(*sec) : end();
+    }
+    auto end(const section_entry& section) const noexcept {
+        return m_layout.end(section);
+    }
+    auto end(const char_type *section) const noexcept {
+        auto sec = find_section(section);
+        return sec != nullptr ? end(*sec) : end();
+    }
+    auto end(view_type section) const noexcept {
+        auto sec = find_section(section);
+        return sec != nullptr ? end(*sec) : end();
+    }
+    auto section(const section_entry& s) const noexcept {
+        return section_view(begin(s), end(s), s.count);
+    }
+    auto section(const char_type *s) const noexcept {
+        return m_layout.section(s);
+    }
+    auto section(view_type s) const noexcept {
+        return m_layout.section(s);
+    }
+};
+
+using blob_config = basic_blob_config<char>;
+
+/**
+ * Layers run-time configs over a base config (e.g. compile-time defaults,
+ * then a config file, then overrides from the environment), each layer
+ * taking precedence over those below it. A lookup finds what it would find
+ * in the topmost layer that holds its key (in its section, if given), or
+ * else in the base.
+ *
+ * The answer to every lookup is resolved once, when the config is made,
+ * into a single hash table, so a lookup takes one probe however many layers
+ * there are. Strings from the base are used in place, so the base must
+ * outlive the layered config (as a constexpr ini_config at namespace scope
+ * does). Only the strings of keys that the layers add or override are
+ * copied, so the layers need not outlive it.
+ */
+template<typename CharT = char>
+class basic_layered_config
+    : public detail::lookup_surface<basic_layered_config<CharT>, CharT>
+{
+public:
+    using char_type = CharT;
+    using view_type = std::basic_string_view<char_type>;
+
+private:
+    friend detail::lookup_surface<basic_layered_config, CharT>;
+
+    // The answer to tryget(key) if 'section' is nullptr, or else to
+    // tryget(section, key). Slots are empty while 'key' is nullptr.
+    struct entry {
+        std::uint64_t hash = 0;
+        const char_type *section = nullptr;
+        const char_type *key = nullptr;
+        const char_type *value = nullptr;
+        std::uint32_t key_size = 0;
+        std::uint32_t value_size = 0;
+    };
+
+    // Gives empty configs a table that misses every lookup
+    constexpr static entry empty_slots[1] = {};
+
+    // The table and the copied strings share a single allocation from
+    // m_resource
+    std::pmr::memory_resource *m_resource = std::pmr::get_default_resource();
+    std::unique_ptr<std::byte[], detail::resource_deleter> m_storage;
+    const entry *m_slots = empty_slots;
+    std::size_t m_mask = 0;
+    std::size_t m_count = 0;
+
+    // Finds the slot of the given lookup in a table of mask + 1 slots, which
+    // is empty if the lookup has no answer
+    template<typename Entry>
+    static Entry& probe(Entry *slots, std::size_t mask, std::uint64_t hash, const view_type *sec,
+        view_type key) noexcept
+    {
+        for (auto i = static_cast<std::size_t>(hash) & mask; ; i = (i + 1) & mask) {
+            auto& e = slots[i];
+            if (e.key == nullptr || (e.hash == hash && (e.section == nullptr) == (sec == nullptr) &&
+                detail::equal_views(view_type(e.key, e.key_size), key) &&
+                (sec == nullptr || detail::stringmatch(e.section, *sec))))
+            {
+                return e;
+            }
+        }
+    }
+    const entry& find(const view_type *sec, const basic_key<char_type>& key) const noexcept {
+        return probe(m_slots, m_mask, key.hash(detail::hash_scope(sec)), sec, key.name());
+    }
+    detail::found_value<char_type> find_value(const view_type *sec,
+        const basic_key<char_type>& key) const noexcept
+    {
+        const auto& e = find(sec, key);
+        return { e.key != nullptr ? view_type(e.value, e.value_size) : view_type() };
+    }
+
+    // Resolves every lookup from the given configs, topmost layer first and
+    // the base last
+    template<typename... Configs>
+    void merge(const Configs&... configs) {
+        static_assert((std::same_as<decltype((*configs.begin()).first), const char_type *> && ...),
+            "Layers must have the layered config's char type!");
+
+        // Each kvp may answer tryget(key) and tryget(section, key); keep the
+        // first answer to each lookup, noting those from layers
+        const std::size_t bound = (std::size_t(0) + ... +
+            static_cast<std::size_t>(configs.end() - configs.begin())) * 2;
+        const auto scratch_mask = std::bit_ceil(std::max<std::size_t>(bound * 2, 1)) - 1;
+        std::pmr::vector<entry> scratch(scratch_mask + 1, m_resource);
+        std::pmr::vector<bool> from_layer(scratch_mask + 1, false, m_resource);
+        std::size_t layer = 0;
+        auto add = [&](const auto& config) {
+            const bool copy = ++layer < sizeof...(Configs);
+            auto answer = [&](const view_type *sec, const auto& kvp, view_type key) {
+                auto hash = basic_key<char_type>(key).hash(detail::hash_scope(sec));
+                auto& e = probe(scratch.data(), scratch_mask, hash, sec, key);
+                if (e.key != nullptr)
+                    return;
+                e = { hash, sec != nullptr ? kvp.section : nullptr, kvp.first, kvp.second,
+                    static_cast<std::uint32_t>(key.size()),
+                    static_cast<std::uint32_t>(std::char_traits<char_type>::length(kvp.second)) };
+                from_layer[static_cast<std::size_t>(&e - scratch.data())] = copy;
+                ++m_count;
+            };
+            for (auto kvp : config) {
+                // A kvp answers a lookup if it holds what the config finds.
+                // Values are compared as strings, since ini_config's
+                // iterators point into a static copy of its text.
+                auto key = view_type(kvp.first);
+                auto value = view_type(kvp.second);
+                if (config.tryget_view(key) == value)
+                    answer(nullptr, kvp, key);
+                if (kvp.section != nullptr) {
+                    auto sec = view_type(kvp.section);
+                    if (config.tryget_view(sec, key) == value)
+                        answer(&sec, kvp, key);
+                }
+            }
+        };
+        (add(configs), ...);
+
+        // Size the copies of the layers' strings, each copied once
+        std::pmr::unordered_map<const char_type *, std::size_t> copies(m_resource);
+        std::size_t chars = 0;
+        auto plan_copy = [&](const char_type *s, std::size_t size) {
+            if (copies.emplace(s, chars).second)
+                chars += size + 1;
+        };
+        for (std::size_t i = 0; i <= scratch_mask; ++i) {
+            const auto& e = scratch[i];
+            if (e.key == nullptr || !from_layer[i])
+                continue;
+            if (e.section != nullptr)
+                plan_copy(e.section, std::char_traits<char_type>::length(e.section));
+            plan_copy(e.key, e.key_size);
+            plan_copy(e.value, e.value_size);
+        }
+
+        // Keep the table at most half full, so that most lookups stop at
+        // their first slot
+        m_mask = std::bit_ceil(std::max<std::size_t>(m_count * 2, 1)) - 1;
+        detail::block_plan plan;
+        auto slots_at = plan.add<entry>(m_mask + 1);
+        auto chars_at = plan.add<char_type>(chars);
+        auto storage = static_cast<std::byte *>(m_resource->allocate(plan.size(), alignof(std::max_align_t)));
+        std::memset(storage, 0, plan.size());
+        m_storage = decltype(m_storage)(storage, { m_resource, plan.size() });
+        auto slots = reinterpret_cast<entry *>(storage + slots_at);
+        auto buffer = reinterpret_cast<char_type *>(storage + chars_at);
+        for (auto [s, at] : copies) {
+            auto end = std::copy(s, s + std::char_traits<char_type>::length(s), buffer + at);
+            *end = '\0';
+        }
+
+        for (std::size_t i = 0; i <= scratch_mask; ++i) {
+            auto e = scratch[i];
+            if (e.key == nullptr)
+                continue;
+            if (from_layer[i]) {
+                if (e.section != nullptr)
+                    e.section = buffer + copies[e.section];
+                e.key = buffer + copies[e.key];
+                e.value = buffer + copies[e.value];
+            }
+            auto sec = e.section != nullptr ? view_type(e.section) : view_type();
+            probe(slots, m_mask, e.hash, e.section != nullptr ? &sec : nullptr, view_type(e.key, e.key_size)) = e;
+        }
+        m_slots = slots;
+    }
+
+    template<std::size_t... I, typename Base, typename... Layers>
+    void merge_layers(std::index_sequence<I...>, const Base& base, const Layers&... layers) {
+        [[maybe_unused]] auto refs = std::tie(layers...);
+        merge(std::get<sizeof...(I) - 1 - I>(refs)..., base);
+    }
+
+public:
+    /**
+     * Constructs an empty config.
+     */
+    basic_layered_config() noexcept = default;
+
+    /**
+     * Layers the given configs over the base, in order from the lowest
+     * layer to the topmost. Any config types with this char type may be
+     * layered (e.g. make_ini_config results, runtime_config, blob_config).
+     * The table and copied strings are allocated from the given resource
+     * if it is passed first, after std::allocator_arg.
+     */
+    template<typename Base, typename... Layers>
+        requires(!std::same_as<Base, std::allocator_arg_t>)
+    explicit basic_layered_config(const Base& base, const Layers&... layers) {
+        merge_layers(std::index_sequence_for<Layers...>{}, base, layers...);
+    }
+    template<typename Base, typename... Layers>
+    basic_layered_config(std::allocator_arg_t, std::pmr::memory_resource *resource,
+        const Base& base, const Layers&... layers)
+        : m_resource(resource)
+    {
+        merge_layers(std::index_sequence_for<Layers...>{}, base, layers...);
+    }
+
+    basic_layered_config(basic_layered_config&& other) noexcept
+        : m_resource(other.m_resource),
+          m_storage(std::move(other.m_storage)),
+          m_slots(std::exchange(other.m_slots, empty_slots)),
+          m_mask(std::exchange(other.m_mask, 0)),
+          m_count(std::exchange(other.m_count, 0)) {}
+    basic_layered_config& operator=(basic_layered_config&& other) noexcept {
+        m_resource = other.m_resource;
+        m_storage = std::move(other.m_storage);
+        m_slots = std::exchange(other.m_slots, empty_slots);
+        m_mask = std::exchange(other.m_mask, 0);
+        m_count = std::exchange(other.m_count, 0);
+        return *this;
+    }
+
+    /**
+     * Returns the number of lookups that have an answer: each distinct key
+     * once for tryget(key), and again for each section holding it.
+     */
+    std::size_t size() const noexcept {
+        return m_count;
+    }
+};
+
+using layered_config = basic_layered_config<char>;
+
+/**
+ * Holds the current version of a run-time config for hot reloading.
+ * Readers take a snapshot, which is an immutable config that stays valid
+ * for as long as they hold it, even across reloads. A writer parses the
+ * new version first and then publishes it with a single pointer swap, so
+ * readers never wait on a parse or see a partly built config. Each
+ * version is freed when its last snapshot is released.
+ * Writers are serialized: a reload holds the writer lock from reading the
+ * current config until it publishes the next one, so that it never
+ * replaces a version that another writer published meanwhile.
+ * Config may be any run-time config type (e.g. runtime_config or
+ * mapped_config).
+ */
+template<typename Config = runtime_config>
+class config_registry
+{
+public:
+    using config_type = Config;
+    using snapshot_type = std::shared_ptr<const Config>;
+
+private:
+#ifdef __cpp_lib_atomic_shared_ptr
+    std::atomic<snapshot_type> m_current;
+
+    snapshot_type load() const noexcept {
+        return m_current.load(std::memory_order_acquire);
+    }
+    snapshot_type swap(snapshot_type next) noexcept {
+        return m_current.exchange(std::move(next), std::memory_order_acq_rel);
+    }
+#else
+    // Standard libraries without std::atomic<std::shared_ptr> still offer
+    // the atomic shared_ptr free functions
+    snapshot_type m_current;
+
+    snapshot_type load() const noexcept {
+        return std::atomic_load_explicit(&m_current, std::memory_order_acquire);
+    }
+    snapshot_type swap(snapshot_type next) noexcept {
+        return std::atomic_exchange_explicit(&m_current, std::move(next),
+            std::memory_order_acq_rel);
+    }
+#endif
+
+    // Held by writers from reading the current config until they publish
+    std::mutex m_writer;
+
+public:
+    /**
+     * Constructs a registry holding an empty config.
+     */
+    config_registry()
+        : m_current(std::make_shared<const Config>()) {}
+    /**
+     * Constructs a registry holding the given config.
+     */
+    explicit config_registry(Config config)
+        : m_current(std::make_shared<const Config>(std::move(config))) {}
+
+    config_registry(const config_registry&) = delete;
+    config_registry& operator=(const config_registry&) = delete;
+
+    /**
+     * Returns the current config. Hold on to the snapshot for a batch of
+     * lookups: lookups through it need no synchronization, and it never
+     * changes.
+     */
+    snapshot_type snapshot() const noexcept {
+        return load();
+    }
+
+    /**
+     * Makes the given config current, returning the previous one.
+     * Readers holding older snapshots are unaffected.
+     */
+    snapshot_type publish(Config config) {
+        auto next = std::make_shared<const Config>(std::move(config));
+        std::lock_guard lock(m_writer);
+        return swap(std::move(next));
+    }
+
+    /**
+     * Parses the given file and publishes it, returning the previous
+     * config. Configs that support it reuse the unchanged parts of the
+     * current config. If the file cannot be read or is invalid, the
+     * exception propagates and the current config is kept.
+     */
+    snapshot_type reload(const char *path) {
+        std::lock_guard lock(m_writer);
+        if constexpr (requires(const char *p, const Config& c) { Config::from_file(p, c); })
+            return swap(std::make_shared<const Config>(Config::from_file(path, *load())));
+        else
+            return swap(std::make_shared<const Config>(Config::from_file(path)));
+    }
+};
+
+} // namespace ini_config
+
+#endif // TCSULLIVAN_INI_CONFIG_RUNTIME_HPP
@@ -0,0 +1,138 @@
+/**
+ * load_async.cpp - Loads configs through load_async() from a source whose
+ * reads give each chunk as a new std::string, some resumed by another
+ * thread, and checks them against the same text parsed at once.
+ *
+ * Build and run with e.g.:
+ *   g++ -std=c++20 -O1 -g -fsanitize=address,undefined -I.. load_async.cpp -o load_async && ./load_async
+ * Returns 1 if any config differs.
+ */
+
+#include "ini_config_runtime.hpp"
+
+#include <algorithm> // std::min
+#include <condition_variable> // std::condition_variable_any
+#include <coroutine> // std::coroutine_handle
+#include <cstdio> // std::fprintf, std::printf
+#include <deque> // std::deque
+#include <mutex> // std::lock_guard, std::mutex, std::unique_lock
+#include <string> // std::string, std::to_string
+#include <string_view> // std::string_view
+#include <thread> // std::jthread, std::stop_token
+
+namespace {
+
+// Resumes coroutines on its own thread, as an I/O executor would
+class executor {
+    std::mutex m_mutex;
+    std::condition_variable_any m_ready;
+    std::deque<std::coroutine_handle<>> m_queue;
+    std::jthread m_thread;
+
+public:
+    executor() : m_thread([this](std::stop_token stop) { run(stop); }) {}
+
+    void post(std::coroutine_handle<> h) {
+        {
+            std::lock_guard lock(m_mutex);
+            m_queue.push_back(h);
+        }
+        m_ready.notify_one();
+    }
+
+private:
+    void run(std::stop_token stop) {
+        std::unique_lock lock(m_mutex);
+        while (m_ready.wait(lock, stop, [this] { return !m_queue.empty(); })) {
+            auto h = m_queue.front();
+            m_queue.pop_front();
+            lock.unlock();
+            h.resume();
+            lock.lock();
+        }
+    }
+};
+
+// Reads a text in chunks of the given size, each returned as a new string.
+// Every other read suspends until the executor resumes it.
+class chunked_source {
+    std::string_view m_text;
+    std::size_t m_chunk;
+    executor *m_executor;
+    unsigned int m_reads = 0;
+
+public:
+    chunked_source(std::string_view text, std::size_t chunk, executor *ex)
+        : m_text(text), m_chunk(chunk), m_executor(ex) {}
+
+    auto async_read() {
+        struct awaiter {
+            chunked_source& s;
+            bool suspend;
+
+            bool await_ready() const noexcept {
+                return !suspend;
+            }
+            void await_suspend(std::coroutine_handle<> h) {
+                s.m_executor->post(h);
+            }
+            std::string await_resume() {
+                auto n = std::min(s.m_chunk, s.m_text.size());
+                std::string chunk(s.m_text.substr(0, n));
+                s.m_text.remove_prefix(n);
+                return chunk;
+            }
+        };
+        return awaiter{ *this, ++m_reads % 2 == 0 };
+    }
+};
+
+std::string sample_text() {
+    std::string text = "; A config split across reads\nglobal = outside\n";
+    for (int s = 0; s < 20; ++s) {
+        text += "[section" + std::to_string(s) + "]\n";
+        for (int k = 0; k < 25; ++k)
+            text += "key" + std::to_string(k) + " = value " + std::to_string(s * 100 + k) + "\n";
+    }
+    return text;
+}
+
+ini_config::task<ini_config::runtime_config> load(chunked_source& source) {
+    co_return co_await ini_config::load_async([&source] { return source.async_read(); });
+}
+
+// Compares every kvp of two configs, in order
+bool same(const ini_config::runtime_config& a, const ini_config::runtime_config& b) {
+    if (a.size() != b.size())
+        return false;
+    auto i = a.begin();
+    auto j = b.begin();
+    for (; i != a.end(); ++i, ++j) {
+        if (std::string_view((*i).section ? (*i).section : "") != std::string_view((*j).section ? (*j).section : "")
+            || std::string_view((*i).first) != std::string_view((*j).first)
+            || std::string_view((*i).second) != std::string_view((*j).second))
+            return false;
+    }
+    return true;
+}
+
+} // namespace
+
+int main() {
+    auto text = sample_text();
+    ini_config::runtime_config expected(text);
+    executor ex;
+
+    int failures = 0;
+    for (std::size_t chunk : { 1, 7, 64, 4096 }) {
+        chunked_source source(text, chunk, &ex);
+        auto config = load(source).get();
+        if (!same(config, expected) || std::string_view(config.tryget("section19", "key24")) != "value 1924") {
+            std::fprintf(stderr, "Chunks of %zu chars: config differs\n", chunk);
+            ++failures;
+        }
+    }
+
+    std::printf("%s\n", failures == 0 ? "load_async: all chunk sizes agree" : "load_async: FAILED");
+    return failures != 0;
+}
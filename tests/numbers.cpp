@@ -0,0 +1,127 @@
+/**
+ * numbers.cpp - Checks the conversion of floats without <charconv> (as done
+ * at compile-time, and for wide chars) against std::from_chars.
+ *
+ * Build and run with e.g.:
+ *   g++ -std=c++20 -O2 -I.. numbers.cpp -o numbers && ./numbers [count [seed]]
+ * Returns 1 if any conversion differs.
+ */
+
+#include "ini_config.hpp"
+
+#include <charconv> // std::from_chars
+#include <cmath> // std::nextafter
+#include <cstdint> // std::uint64_t
+#include <cstdio> // std::fprintf, std::printf, std::snprintf
+#include <cstdlib> // std::strtoull
+#include <cstring> // std::memcmp, std::memcpy
+#include <limits> // std::numeric_limits
+#include <string> // std::string, std::to_string
+#include <string_view> // std::string_view
+
+namespace {
+
+// Converts as compile-time lookups do
+template<typename T>
+constexpr T convert(std::string_view text) {
+    return ini_config::detail::to_float<T>(ini_config::detail::scan_float(text.data(), text.data() + text.size()));
+}
+
+// Cases that the former long double loop rounded wrongly
+static_assert(convert<double>("85609528373995754e241") == 8.5609528373995749e+257);
+static_assert(convert<double>("2.2250738585072011e-308") == 2.2250738585072011e-308);
+static_assert(convert<double>("4.9406564584124654e-324") == 4.9406564584124654e-324);
+static_assert(convert<double>("2.4703282292062327e-324") == 0.0);
+static_assert(convert<double>("2.4703282292062328e-324") == 4.9406564584124654e-324);
+static_assert(convert<double>("1.7976931348623157e308") == 1.7976931348623157e308);
+static_assert(convert<double>("1.7976931348623159e308") == __builtin_huge_val());
+static_assert(convert<float>("16777217") == 16777216.0f);
+static_assert(convert<float>("3.4028235e38") == 3.4028235e38f);
+
+// The same through a config, at compile-time
+constexpr auto config = make_ini_config<"x = 85609528373995754e241\n">;
+static_assert(config.get<double>("x") == 8.5609528373995749e+257);
+
+struct rng {
+    std::uint64_t state;
+
+    std::uint64_t next() noexcept {
+        auto z = (state += 0x9E3779B97F4A7C15ull);
+        z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+        z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+        return z ^ (z >> 31);
+    }
+    unsigned int below(unsigned int n) noexcept {
+        return static_cast<unsigned int>(next() % n);
+    }
+};
+
+// Makes a random decimal: a mantissa of up to 40 digits, maybe with a
+// fraction, and an exponent near the range of doubles
+std::string make_input(rng& r) {
+    std::string text;
+    auto digits = 1 + r.below(r.below(4) == 0 ? 40 : 17);
+    auto point = r.below(3) == 0 ? r.below(digits + 1) : digits;
+    for (unsigned int i = 0; i < digits; ++i) {
+        if (i == point && i != 0)
+            text += '.';
+        text += static_cast<char>('0' + r.below(10));
+    }
+    auto exponent = static_cast<int>(r.below(661)) - 330;
+    text += 'e' + std::to_string(exponent);
+    return text;
+}
+
+// Makes a decimal at or next to the halfway point between two doubles
+std::string make_halfway(rng& r) {
+    double d = 0;
+    auto bits = r.next() & 0x7FEFFFFFFFFFFFFFull;
+    std::memcpy(&d, &bits, sizeof(d));
+    auto up = std::nextafter(d, std::numeric_limits<double>::infinity());
+    char buf[800];
+    // The midpoint is exact in x86's long double, and printed exactly
+    auto mid = static_cast<long double>(d) + (static_cast<long double>(up) - d) / 2;
+    std::snprintf(buf, sizeof(buf), "%.770Le", mid);
+    std::string text(buf);
+    if (r.below(2) == 0) {
+        auto e = text.find('e');
+        auto last = text.find_last_not_of('0', e - 1);
+        text = text.substr(0, last + 1) + (r.below(2) == 0 ? "1" : "") + text.substr(e);
+    }
+    return text;
+}
+
+template<typename T>
+bool check(const std::string& text) {
+    T expected = 0;
+    auto [ptr, ec] = std::from_chars(text.data(), text.data() + text.size(), expected);
+    if (ec == std::errc::result_out_of_range) {
+        auto scan = ini_config::detail::scan_float(text.data(), text.data() + text.size());
+        expected = scan.mantissa != 0 && scan.exponent > 0 ? std::numeric_limits<T>::infinity() : T(0);
+    }
+    auto value = convert<T>(text);
+    if (std::memcmp(&value, &expected, sizeof(T)) != 0) {
+        std::fprintf(stderr, "%s: %.17g, expected %.17g\n", text.c_str(),
+            static_cast<double>(value), static_cast<double>(expected));
+        return false;
+    }
+    return true;
+}
+
+} // namespace
+
+int main(int argc, char **argv) {
+    const auto count = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 200000;
+    rng r{ argc > 2 ? std::strtoull(argv[2], nullptr, 10) : 1 };
+
+    unsigned long long failures = 0;
+    for (unsigned long long i = 0; i < count; ++i) {
+        auto text = make_input(r);
+        failures += !check<double>(text);
+        failures += !check<float>(text);
+        if (std::numeric_limits<long double>::digits > 54 && i % 16 == 0)
+            failures += !check<double>(make_halfway(r));
+    }
+    std::printf("%llu inputs: %llu differ from std::from_chars\n", count, failures);
+    return failures != 0;
+}
@@ -0,0 +1,211 @@
+/**
+ * pmr.cpp - Checks that run-time configs take all of their memory, and the
+ * scratch memory used while parsing, from the memory resource they are
+ * given: never from the default resource, only on the calling thread, as
+ * a single block once built, and all of it returned when they are
+ * destroyed. Covers parsing (small and large texts), re-parsing, reading
+ * files, config_loader, blob(), and layered_config, and parsing into a
+ * fixed arena that cannot grow.
+ *
+ * Build and run with e.g.:
+ *   g++ -std=c++20 -O1 -g -fsanitize=address,undefined -I.. pmr.cpp -o pmr && ./pmr
+ * Returns 1 if any check fails.
+ */
+
+#include "ini_config_runtime.hpp"
+
+#include <cstddef> // std::byte, std::max_align_t, std::size_t
+#include <cstdio> // std::fprintf, std::printf
+#include <filesystem> // std::filesystem::temp_directory_path
+#include <fstream> // std::ofstream
+#include <memory> // std::allocator_arg
+#include <memory_resource> // std::pmr::memory_resource, std::pmr::monotonic_buffer_resource
+#include <new> // std::bad_alloc
+#include <string> // std::string, std::to_string
+#include <string_view> // std::string_view
+#include <thread> // std::this_thread::get_id, std::thread::id
+
+namespace {
+
+// Counts the blocks and bytes that are allocated and not yet freed, and
+// any allocation made from a thread other than the one that made it
+class counting_resource : public std::pmr::memory_resource {
+    std::pmr::memory_resource *m_upstream = std::pmr::new_delete_resource();
+    std::thread::id m_owner = std::this_thread::get_id();
+
+public:
+    std::size_t allocations = 0;
+    std::size_t live_blocks = 0;
+    std::size_t live_bytes = 0;
+    std::size_t foreign_threads = 0;
+
+private:
+    void *do_allocate(std::size_t bytes, std::size_t alignment) override {
+        ++allocations;
+        ++live_blocks;
+        live_bytes += bytes;
+        foreign_threads += std::this_thread::get_id() != m_owner;
+        return m_upstream->allocate(bytes, alignment);
+    }
+    void do_deallocate(void *p, std::size_t bytes, std::size_t alignment) override {
+        --live_blocks;
+        live_bytes -= bytes;
+        m_upstream->deallocate(p, bytes, alignment);
+    }
+    bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override {
+        return this == &other;
+    }
+};
+
+int failures = 0;
+
+void expect(bool ok, const char *what) {
+    if (!ok) {
+        std::fprintf(stderr, "%s\n", what);
+        ++failures;
+    }
+}
+
+std::string make_text(int sections, int keys) {
+    std::string text = "global = outside\n";
+    for (int s = 0; s < sections; ++s) {
+        text += "[section" + std::to_string(s) + "]\n";
+        for (int k = 0; k < keys; ++k)
+            text += "key" + std::to_string(k) + " = value " + std::to_string(s * keys + k) + "\n";
+    }
+    return text;
+}
+
+// Checks that a config was built from the resource as one block, and
+// gives every block back when it is destroyed
+template<typename Make>
+void check_config(const char *name, Make make) {
+    counting_resource resource;
+    {
+        auto config = make(&resource);
+        if (config.resource() != &resource || resource.live_blocks != 1) {
+            std::fprintf(stderr, "%s: %zu blocks live after building\n", name, resource.live_blocks);
+            ++failures;
+        }
+        if (!config.trycontains("section3", "key7")) {
+            std::fprintf(stderr, "%s: lookup failed\n", name);
+            ++failures;
+        }
+    }
+    if (resource.live_blocks != 0 || resource.live_bytes != 0 || resource.foreign_threads != 0) {
+        std::fprintf(stderr, "%s: %zu blocks of %zu bytes leaked, %zu allocations from other threads\n",
+            name, resource.live_blocks, resource.live_bytes, resource.foreign_threads);
+        ++failures;
+    }
+}
+
+} // namespace
+
+int main() {
+    // Any use of the default resource is counted as a failure below
+    counting_resource stray;
+    std::pmr::set_default_resource(&stray);
+
+    const auto text = make_text(20, 10);
+    auto edited = text;
+    edited.replace(edited.find("value 37"), 8, "value 370");
+    auto renamed = text;
+    renamed.replace(renamed.find("key9 = value 39"), 4, "other");
+
+    check_config("runtime_config", [&](auto *r) { return ini_config::runtime_config(text, r); });
+    check_config("runtime_config<sorted>",
+        [&](auto *r) { return ini_config::basic_runtime_config<char, ini_config::sorted_index>(text, r); });
+
+    // A text large enough to be parsed on several threads, given several cores
+    const auto large = make_text(20000, 10);
+    check_config("runtime_config (large)", [&](auto *r) { return ini_config::runtime_config(large, r); });
+
+    // Re-parsing takes the previous config's resource unless given one
+    {
+        counting_resource resource;
+        {
+            const ini_config::runtime_config previous(text, &resource);
+            const ini_config::runtime_config values(edited, previous);
+            const ini_config::runtime_config keys(renamed, previous);
+            expect(values.resource() == &resource && keys.resource() == &resource,
+                "Re-parsed configs did not keep the previous config's resource");
+            expect(resource.live_blocks == 3, "Re-parsed configs are not one block each");
+            expect(std::string_view(values.tryget("section3", "key7")) == "value 370" &&
+                std::string_view(keys.tryget("section3", "other")) == "value 39",
+                "Re-parsed configs give the wrong values");
+        }
+        expect(resource.live_blocks == 0, "Re-parsed configs leaked");
+    }
+    check_config("runtime_config (re-parsed with a new resource)", [&](auto *r) {
+        counting_resource other;
+        const ini_config::runtime_config previous(text, &other);
+        return ini_config::runtime_config(edited, previous, r);
+    });
+
+    const auto path = (std::filesystem::temp_directory_path() / "ini_config_pmr.ini").string();
+    std::ofstream(path, std::ios::binary) << text;
+    check_config("from_file", [&](auto *r) { return ini_config::runtime_config::from_file(path.c_str(), r); });
+    check_config("from_file (re-parsed)", [&](auto *r) {
+        const ini_config::runtime_config previous(edited, r);
+        return ini_config::runtime_config::from_file(path.c_str(), previous);
+    });
+    std::filesystem::remove(path);
+
+    check_config("config_loader", [&](auto *r) {
+        ini_config::config_loader<> loader(r);
+        for (std::size_t at = 0; at < text.size(); at += 100)
+            loader.feed(std::string_view(text).substr(at, 100));
+        return loader.finish();
+    });
+
+    // Blobs come from the config's resource
+    {
+        counting_resource resource;
+        {
+            const ini_config::runtime_config config(text, &resource);
+            auto blob = config.blob();
+            expect(blob.get_allocator().resource() == &resource && resource.live_blocks == 2,
+                "blob() did not allocate from the config's resource");
+        }
+        expect(resource.live_blocks == 0, "blob() leaked");
+    }
+
+    // A layered config's table comes from its own resource, apart from the
+    // resources of its layers
+    {
+        counting_resource layers;
+        const ini_config::runtime_config base(text, &layers);
+        const ini_config::runtime_config top(edited, &layers);
+        counting_resource resource;
+        {
+            ini_config::layered_config config(std::allocator_arg, &resource, base, top);
+            expect(resource.live_blocks == 1 && layers.live_blocks == 2,
+                "layered_config is not one block from its resource");
+            expect(std::string_view(config.tryget("section3", "key7")) == "value 370",
+                "layered_config gives the wrong value");
+        }
+        expect(resource.live_blocks == 0 && resource.foreign_threads == 0, "layered_config leaked");
+    }
+
+    // A fixed arena that cannot grow is enough for a small config
+    {
+        alignas(std::max_align_t) static std::byte buffer[1 << 16];
+        std::pmr::monotonic_buffer_resource arena(buffer, sizeof(buffer), std::pmr::null_memory_resource());
+        try {
+            const ini_config::runtime_config config(text, &arena);
+            expect(std::string_view(config.tryget("section19", "key9")) == "value 199",
+                "Arena config gives the wrong value");
+        } catch (const std::bad_alloc&) {
+            expect(false, "A 64 KiB arena was not enough");
+        }
+    }
+
+    std::pmr::set_default_resource(nullptr);
+    if (stray.allocations != 0) {
+        std::fprintf(stderr, "%zu allocations came from the default resource\n", stray.allocations);
+        ++failures;
+    }
+
+    std::printf("%s\n", failures == 0 ? "pmr: every config used only its own resource" : "pmr: FAILED");
+    return failures != 0;
+}
@@ -0,0 +1,111 @@
+/**
+ * profile.cpp - Checks configs laid out by the profile option against the
+ * same text without it, under each index policy: iteration must keep the
+ * text's order, and every lookup (in a section or globally, of profiled
+ * keys, of other keys, and of keys that are missing) must find the same
+ * value. The profile names keys in brackets and bare, keys found in more
+ * than one section, and keys that are not in the config.
+ *
+ * Build and run with e.g.:
+ *   g++ -std=c++20 -O1 -g -fsanitize=address,undefined -I.. profile.cpp -o profile && ./profile
+ * Returns 1 if any lookup differs.
+ */
+
+#include "ini_config.hpp"
+
+#include <cstdio> // std::fprintf, std::printf
+#include <string_view> // std::string_view
+
+namespace {
+
+constexpr auto text = ini_config::string_container(R"(
+debug = false
+port = 1
+[Cat]
+lives = 9
+color = gray
+port = 2
+[Dog]
+lives = 1
+color = brown
+name = Rex
+[Cat]
+toy = yarn
+[Empty]
+[Bird]
+port = 3
+)");
+
+constexpr const char *keys[] = {
+    "debug", "port", "lives", "color", "name", "toy", "missing", "", "[Cat]lives", "Cat"
+};
+constexpr const char *sections[] = { "Cat", "Dog", "Bird", "Empty", "missing", "" };
+
+int failures = 0;
+
+std::string_view text_of(const char *s) {
+    return s != nullptr ? std::string_view(s) : std::string_view("(none)");
+}
+
+// Checks every lookup of a profiled config against the plain config
+template<typename Profiled, typename Plain>
+void check(const char *name, const Profiled& profiled, const Plain& plain) {
+    auto i = profiled.begin();
+    for (const auto& kvp : plain) {
+        if (text_of(i->section) != text_of(kvp.section) || text_of(i->first) != kvp.first ||
+            text_of(i->second) != kvp.second)
+        {
+            std::fprintf(stderr, "%s: kvp %s is out of order\n", name, kvp.first);
+            ++failures;
+        }
+        ++i;
+    }
+
+    for (const auto *key : keys) {
+        if (text_of(profiled.tryget(key)) != text_of(plain.tryget(key)) ||
+            profiled.trycontains(key) != plain.trycontains(key) ||
+            profiled.template tryget<int>(key) != plain.template tryget<int>(key))
+        {
+            std::fprintf(stderr, "%s: lookups of %s differ\n", name, key);
+            ++failures;
+        }
+        for (const auto *sec : sections) {
+            if (text_of(profiled.tryget(sec, key)) != text_of(plain.tryget(sec, key)) ||
+                profiled.tryget_view(sec, key) != plain.tryget_view(sec, key) ||
+                profiled.trycontains(sec, key) != plain.trycontains(sec, key))
+            {
+                std::fprintf(stderr, "%s: lookups of %s/%s differ\n", name, sec, key);
+                ++failures;
+            }
+        }
+    }
+}
+
+// A profile with keys of several sections, duplicates, and stale entries
+using hot = ini_config::profile<"[Cat]lives", "port", "[Dog]color", "[Cat]toy", "[Bird]port",
+    "[Gone]key", "missing", "[Cat]port", "lives", "[Empty]x", "debug">;
+
+// Checks each index policy, with and without the profile
+template<typename Policy>
+void check_policy(const char *name) {
+    constexpr auto plain = make_ini_config<text, Policy>;
+    check(name, make_ini_config<text, Policy, hot>, plain);
+    check(name, make_ini_config<text, Policy, ini_config::profile<"[Dog]name">>, plain);
+    check(name, make_ini_config<text, Policy, ini_config::profile<"[Nowhere]x", "nothing">>, plain);
+}
+
+} // namespace
+
+int main() {
+    check_policy<ini_config::perfect_hash_index>("perfect_hash_index");
+    check_policy<ini_config::sorted_index>("sorted_index");
+    check_policy<ini_config::linear_index>("linear_index");
+
+    // Profiled configs agree with each other, whatever their index
+    check("sorted_index against linear_index", make_ini_config<text, ini_config::sorted_index, hot>,
+        make_ini_config<text, ini_config::linear_index, hot>);
+
+    std::printf("%s\n", failures == 0 ? "profile: every profiled config agrees with the plain config" :
+        "profile: FAILED");
+    return failures != 0;
+}
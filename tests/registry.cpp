@@ -0,0 +1,130 @@
+/**
+ * registry.cpp - Publishes 2000 versions of a config to a config_registry
+ * from two writer threads, and reloads it from a file on a third, while
+ * eight reader threads take snapshots. Every snapshot must be a whole
+ * version, each writer's versions must appear in order, and every version
+ * but the last must be replaced exactly once.
+ *
+ * Build and run with e.g.:
+ *   g++ -std=c++20 -O1 -g -fsanitize=address,undefined -I.. registry.cpp -o registry && ./registry
+ * Returns 1 if any check fails. With -fsanitize=thread, GCC 12 reports a
+ * race within std::atomic<std::shared_ptr> itself, whose load() releases
+ * its lock with a relaxed store.
+ */
+
+#include "ini_config_runtime.hpp"
+
+#include <atomic> // std::atomic
+#include <cstdio> // std::fopen, std::fprintf, std::printf, std::remove
+#include <filesystem> // std::filesystem::temp_directory_path
+#include <mutex> // std::lock_guard, std::mutex
+#include <string> // std::string, std::to_string
+#include <thread> // std::jthread
+#include <vector> // std::vector
+
+namespace {
+
+constexpr int readers = 8;
+constexpr int writers = 2;
+constexpr int publishes = 2000; // Shared between the writers
+constexpr int reloads = 100;
+constexpr int reloader = writers; // The writer id of reloaded versions
+
+// A version of the config: which writer made it, its number among that
+// writer's versions, and a check value that a torn config would not match
+std::string version_text(int writer, int version) {
+    return "[version]\nwriter = " + std::to_string(writer) + "\nnumber = " + std::to_string(version) +
+        "\ncheck = " + std::to_string(version * 7 + writer) + "\n";
+}
+
+std::atomic<int> failures = 0;
+
+void fail(const char *what, int writer, int version) {
+    std::fprintf(stderr, "%s (writer %d, version %d)\n", what, writer, version);
+    ++failures;
+}
+
+} // namespace
+
+int main() {
+    ini_config::config_registry<> registry(ini_config::runtime_config(version_text(0, -1)));
+    const auto path = (std::filesystem::temp_directory_path() / "ini_config_registry.ini").string();
+
+    // Versions that publish() or reload() returned as replaced, by writer
+    std::mutex replaced_mutex;
+    std::vector<std::vector<int>> replaced(writers + 1);
+    auto note_replaced = [&](const auto& previous) {
+        std::lock_guard lock(replaced_mutex);
+        replaced[previous->template tryget<int>("version", "writer")].push_back(
+            previous->template tryget<int>("version", "number"));
+    };
+
+    std::atomic<bool> done = false;
+    std::atomic<long> snapshots = 0;
+    {
+        std::vector<std::jthread> threads;
+        for (int r = 0; r < readers; ++r) {
+            threads.emplace_back([&] {
+                int last[writers + 1] = { -1, -1, -1 };
+                do {
+                    auto config = registry.snapshot();
+                    int writer = config->tryget<int>("version", "writer");
+                    int version = config->tryget<int>("version", "number");
+                    if (config->size() != 3 || writer < 0 || writer > writers ||
+                        config->tryget<int>("version", "check") != version * 7 + writer)
+                        fail("Snapshot is not a whole version", writer, version);
+                    else if (version < last[writer])
+                        fail("Snapshot is older than one taken before it", writer, version);
+                    else
+                        last[writer] = version;
+                    ++snapshots;
+                } while (!done);
+            });
+        }
+
+        {
+            std::vector<std::jthread> writing;
+            for (int w = 0; w < writers; ++w) {
+                writing.emplace_back([&, w] {
+                    for (int v = 0; v < publishes / writers; ++v)
+                        note_replaced(registry.publish(ini_config::runtime_config(version_text(w, v))));
+                });
+            }
+            writing.emplace_back([&] {
+                for (int v = 0; v < reloads; ++v) {
+                    // Each file is written before the reload that reads it
+                    auto text = version_text(reloader, v);
+                    auto file = std::fopen(path.c_str(), "wb");
+                    std::fwrite(text.data(), 1, text.size(), file);
+                    std::fclose(file);
+                    note_replaced(registry.reload(path.c_str()));
+                }
+            });
+        }
+        done = true;
+    }
+    std::remove(path.c_str());
+
+    // The initial version and every published one but the current are
+    // replaced once each
+    auto current = registry.snapshot();
+    std::vector<int> expected_count = { publishes / writers, publishes / writers, reloads };
+    expected_count[0] += 1; // The initial version
+    --expected_count[current->tryget<int>("version", "writer")];
+    for (int w = 0; w <= writers; ++w) {
+        auto& versions = replaced[w];
+        if (versions.size() != static_cast<std::size_t>(expected_count[w]))
+            fail("Wrong number of versions replaced", w, static_cast<int>(versions.size()));
+        std::vector<bool> seen(versions.size() + 1);
+        for (int v : versions) {
+            if (v + 1 < 0 || static_cast<std::size_t>(v + 1) >= seen.size() || seen[v + 1])
+                fail("Version replaced twice, or never published", w, v);
+            else
+                seen[v + 1] = true;
+        }
+    }
+
+    std::printf("%s (%ld snapshots)\n", failures == 0 ? "registry: every snapshot was a whole version in order" :
+        "registry: FAILED", snapshots.load());
+    return failures != 0;
+}
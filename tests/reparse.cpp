@@ -0,0 +1,221 @@
+/**
+ * reparse.cpp - Makes random edits to an INI text, re-parsing each version
+ * against the config of the one before it, and checks every result against
+ * the same text parsed from scratch: the same kvps in the same order, the
+ * same lookups, and the same blob. Edits that only change values take the
+ * path that copies unchanged blocks; the rest fall back to a full parse.
+ * Invalid edits must fail on the same line as a fresh parse.
+ *
+ * Build and run with e.g.:
+ *   g++ -std=c++20 -O1 -g -fsanitize=address,undefined -I.. reparse.cpp -o reparse && ./reparse [edits [seed]]
+ * Returns 1 if any result differs.
+ */
+
+#include "ini_config_runtime.hpp"
+
+#include <algorithm> // std::equal
+#include <cstdint> // std::uint64_t
+#include <cstdio> // std::fprintf, std::printf
+#include <cstdlib> // std::strtoull
+#include <optional> // std::optional
+#include <string> // std::string, std::to_string
+#include <string_view> // std::string_view
+#include <vector> // std::vector
+
+namespace {
+
+struct rng {
+    std::uint64_t state;
+
+    std::uint64_t next() noexcept {
+        auto z = (state += 0x9E3779B97F4A7C15ull);
+        z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+        z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+        return z ^ (z >> 31);
+    }
+    unsigned int below(unsigned int n) noexcept {
+        return static_cast<unsigned int>(next() % n);
+    }
+};
+
+// Keys come from a small pool, so that sections repeat them and the
+// global lookup has duplicates to choose between
+std::string make_key(rng& r) {
+    return "key" + std::to_string(r.below(12));
+}
+std::string make_value(rng& r) {
+    switch (r.below(3)) {
+    case 0:
+        return std::to_string(static_cast<int>(r.below(100000)) - 50000);
+    case 1:
+        return r.below(2) == 0 ? "yes" : "off";
+    default: {
+        std::string value;
+        for (auto n = 1 + r.below(24); n != 0; --n)
+            value += static_cast<char>('a' + r.below(26));
+        return value;
+    }
+    }
+}
+std::string make_kvp(rng& r) {
+    return make_key(r) + " = " + make_value(r);
+}
+std::string make_section(rng& r) {
+    return "[section" + std::to_string(r.below(8)) + "]";
+}
+
+std::vector<std::string> make_lines(rng& r) {
+    std::vector<std::string> lines;
+    for (auto n = 1 + r.below(4); n != 0; --n)
+        lines.push_back(make_kvp(r));
+    for (auto s = 1 + r.below(6); s != 0; --s) {
+        lines.push_back(make_section(r));
+        for (auto n = r.below(10); n != 0; --n)
+            lines.push_back(r.below(8) == 0 ? "; comment" : make_kvp(r));
+    }
+    return lines;
+}
+
+std::string join(const std::vector<std::string>& lines) {
+    std::string text;
+    for (const auto& line : lines)
+        text += line + '\n';
+    return text;
+}
+
+// Edits one line. Most edits change only a value, which re-parsing
+// handles without a full parse.
+void edit(rng& r, std::vector<std::string>& lines) {
+    auto at = r.below(static_cast<unsigned int>(lines.size()));
+    auto& line = lines[at];
+    auto eq = line.find(" = ");
+    switch (r.below(10)) {
+    case 0:
+        if (eq != std::string::npos)
+            line = make_key(r) + line.substr(eq);
+        break;
+    case 1:
+        lines.insert(lines.begin() + at, make_kvp(r));
+        break;
+    case 2:
+        if (lines.size() > 1)
+            lines.erase(lines.begin() + at);
+        break;
+    case 3:
+        lines.insert(lines.begin() + at, r.below(2) == 0 ? "; comment" : "");
+        break;
+    case 4:
+        lines.insert(lines.begin() + at, make_section(r));
+        break;
+    default:
+        if (eq != std::string::npos)
+            line = line.substr(0, eq) + " = " + make_value(r);
+        break;
+    }
+}
+
+std::string_view text_of(const char *s) {
+    return s != nullptr ? std::string_view(s) : std::string_view("(none)");
+}
+
+// Compares a re-parsed config with one parsed from scratch
+bool same(const ini_config::runtime_config& reparsed, const ini_config::runtime_config& fresh) {
+    if (reparsed.size() != fresh.size()) {
+        std::fprintf(stderr, "%u kvps, expected %u\n", reparsed.size(), fresh.size());
+        return false;
+    }
+    auto i = reparsed.begin();
+    for (auto j = fresh.begin(); j != fresh.end(); ++i, ++j) {
+        auto a = *i;
+        auto b = *j;
+        if (text_of(a.section) != text_of(b.section) || text_of(a.first) != text_of(b.first) ||
+            text_of(a.second) != text_of(b.second))
+        {
+            std::fprintf(stderr, "kvp %s/%s = %s, expected %s/%s = %s\n", text_of(a.section).data(),
+                a.first, a.second, text_of(b.section).data(), b.first, b.second);
+            return false;
+        }
+
+        // Lookups must find the same kvp as the fresh config's
+        auto key = std::string_view(b.first);
+        if (std::string_view(reparsed.tryget(key)) != fresh.tryget(key) ||
+            reparsed.tryget_view(key) != fresh.tryget_view(key) ||
+            reparsed.tryget<long>(key) != fresh.tryget<long>(key) ||
+            (b.section != nullptr &&
+                std::string_view(reparsed.tryget(b.section, key)) != fresh.tryget(b.section, key)))
+        {
+            std::fprintf(stderr, "Lookups of %s differ\n", b.first);
+            return false;
+        }
+    }
+    if (reparsed.trycontains("missing") || reparsed.trycontains("section0", "missing")) {
+        std::fprintf(stderr, "Found a missing key\n");
+        return false;
+    }
+
+    auto a = reparsed.blob();
+    auto b = fresh.blob();
+    if (a.size() != b.size() || !std::equal(a.begin(), a.end(), b.begin())) {
+        std::fprintf(stderr, "Blobs differ\n");
+        return false;
+    }
+    return true;
+}
+
+// Parses the text, returning the line of the error if it is invalid
+std::optional<unsigned int> error_line(const std::string& text, const ini_config::runtime_config *previous) {
+    try {
+        if (previous != nullptr)
+            ini_config::runtime_config(text, *previous);
+        else
+            ini_config::runtime_config{ std::string_view(text) };
+    } catch (const ini_config::parse_error& e) {
+        return e.line();
+    }
+    return std::nullopt;
+}
+
+} // namespace
+
+int main(int argc, char **argv) {
+    const auto edits = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 20000;
+    rng r{ argc > 2 ? std::strtoull(argv[2], nullptr, 10) : 1 };
+
+    unsigned long long failures = 0;
+    auto lines = make_lines(r);
+    ini_config::runtime_config config{ std::string_view(join(lines)) };
+    for (unsigned long long n = 0; n < edits; ++n) {
+        // Start over now and then, so that texts stay small
+        if (n % 200 == 0) {
+            lines = make_lines(r);
+            config = ini_config::runtime_config{ std::string_view(join(lines)) };
+        }
+
+        // An invalid line must be reported where a fresh parse reports it
+        if (r.below(50) == 0) {
+            auto broken = lines;
+            broken.insert(broken.begin() + r.below(static_cast<unsigned int>(broken.size())),
+                r.below(2) == 0 ? "[unclosed" : "no value");
+            auto text = join(broken);
+            auto line = error_line(text, &config);
+            if (!line || line != error_line(text, nullptr)) {
+                std::fprintf(stderr, "Edit %llu: error reported on the wrong line\n", n);
+                ++failures;
+            }
+            continue;
+        }
+
+        for (auto k = 1 + r.below(3); k != 0; --k)
+            edit(r, lines);
+        auto text = join(lines);
+        ini_config::runtime_config reparsed(text, config);
+        if (!same(reparsed, ini_config::runtime_config{ std::string_view(text) })) {
+            std::fprintf(stderr, "Edit %llu differs, giving:\n%s\n", n, text.c_str());
+            ++failures;
+        }
+        config = std::move(reparsed);
+    }
+
+    std::printf("%llu edits: %llu differ from a fresh parse\n", edits, failures);
+    return failures != 0;
+}
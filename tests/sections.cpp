@@ -0,0 +1,141 @@
+/**
+ * sections.cpp - Checks the sections<> and drop_number_text options against
+ * the same text without them: kept sections (and "" for the keys above the
+ * first header) must give the same kvps, in order, and the same lookups;
+ * dropped sections must be missing; and values that are numbers must read
+ * as "" while contains(), trycontains(), handles, and compile-time get<T>()
+ * still find and convert them, as does tryget<T>() given value_cache.
+ *
+ * Build and run with e.g.:
+ *   g++ -std=c++20 -O1 -g -fsanitize=address,undefined -I.. sections.cpp -o sections && ./sections
+ * Returns 1 if any check fails.
+ */
+
+#include "ini_config.hpp"
+
+#include <cstdio> // std::fprintf, std::printf
+#include <string_view> // std::string_view
+
+namespace {
+
+constexpr auto text = ini_config::string_container(R"(
+top = 1
+name = outside
+[Net]
+port = 8080
+host = example.org
+retries = 0x10
+scale = 2.5e3
+enabled = yes
+[Log]
+level = 3
+path = /var/log/app
+[Unused]
+port = 9090
+blob = aaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaa
+[Net]
+port = 1
+)");
+
+constexpr auto full = make_ini_config<text>;
+constexpr auto kept = make_ini_config<text, ini_config::sections<"Net", "Log">>;
+constexpr auto kept_global = make_ini_config<text, ini_config::sections<"", "Log">>;
+constexpr auto dropped = make_ini_config<text, ini_config::sections<"Net", "Log">,
+    ini_config::drop_number_text>;
+constexpr auto dropped_cached = make_ini_config<text, ini_config::sections<"Net", "Log">,
+    ini_config::drop_number_text, ini_config::value_cache>;
+
+// Only the kept sections, and their chars, are embedded
+static_assert(kept.size() == 8 && kept_global.size() == 4);
+static_assert(sizeof(kept) < sizeof(full));
+static_assert(sizeof(dropped) < sizeof(kept));
+
+// Compile-time conversions read the dropped text
+static_assert(dropped.get<int>("Net", "port") == 8080);
+static_assert(dropped.get<int>("Net", "retries") == 16);
+static_assert(dropped.get<double>("Net", "scale") == 2500.0);
+static_assert(dropped.get<int>("Log", "level") == 3);
+static_assert(dropped.handle<"Net", "port", int>().value() == 8080);
+static_assert(std::string_view(dropped.get("Net", "port")).empty());
+static_assert(dropped.contains("Net", "port") && dropped.contains("Log", "level"));
+static_assert(std::string_view(dropped.get("Net", "host")) == "example.org");
+
+int failures = 0;
+
+void expect(bool ok, const char *what) {
+    if (!ok) {
+        std::fprintf(stderr, "%s\n", what);
+        ++failures;
+    }
+}
+
+// Checks that a filtered config gives the full config's kvps of the kept
+// sections, in order, and the same lookups of them
+template<typename Config>
+void check_kept(const char *name, const Config& config, bool (*keep)(std::string_view)) {
+    auto i = config.begin();
+    for (const auto& kvp : full) {
+        const std::string_view sec = kvp.section != nullptr ? kvp.section : "";
+        if (!keep(sec))
+            continue;
+        if (i == config.end() || std::string_view((*i).first) != kvp.first ||
+            std::string_view((*i).second) != kvp.second)
+        {
+            std::fprintf(stderr, "%s: kvp %s/%s is missing or out of order\n", name, sec.data(), kvp.first);
+            ++failures;
+            return;
+        }
+        ++i;
+        if (kvp.section != nullptr &&
+            std::string_view(config.tryget(kvp.section, kvp.first)) != full.tryget(kvp.section, kvp.first))
+        {
+            std::fprintf(stderr, "%s: lookup of %s/%s differs\n", name, sec.data(), kvp.first);
+            ++failures;
+        }
+    }
+    if (i != config.end()) {
+        std::fprintf(stderr, "%s: has kvps of a dropped section\n", name);
+        ++failures;
+    }
+}
+
+} // namespace
+
+int main() {
+    check_kept("sections<Net, Log>", kept, [](std::string_view sec) { return sec == "Net" || sec == "Log"; });
+    check_kept("sections<\"\", Log>", kept_global, [](std::string_view sec) { return sec == "" || sec == "Log"; });
+
+    expect(!kept.trycontains("Unused", "port") && !kept.trycontains("blob") && !kept.trycontains("top"),
+        "sections<Net, Log> kept a dropped section");
+    expect(std::string_view(kept.tryget("port")) == "8080",
+        "sections<Net, Log> found a global key in a dropped section");
+    expect(std::string_view(kept_global.tryget("top")) == "1" && !kept_global.trycontains("Net", "port"),
+        "sections<\"\", Log> did not keep only the keys above the first header");
+    expect(std::string_view(kept.tryget("Net", "port")) == "8080" && kept.tryget<int>("Net", "port") == 8080,
+        "sections<Net, Log> gives the wrong value of the first Net section");
+
+    // Numbers lose their text but are still found; other values keep theirs
+    for (const auto *key : { "port", "retries", "scale" }) {
+        expect(dropped.tryget_view("Net", key).empty() && dropped.trycontains("Net", key),
+            "drop_number_text kept a number, or lost its key");
+    }
+    expect(dropped.tryget_view("Net", "host") == "example.org" && dropped.tryget_view("Net", "enabled") == "yes" &&
+        dropped.tryget_view("Log", "path") == "/var/log/app", "drop_number_text dropped a string");
+    expect(dropped.tryget<bool>("Net", "enabled"), "drop_number_text broke a bool kept as text");
+    expect(dropped.tryconvert<int>("Net", "port").error() == ini_config::conversion_error::invalid_value,
+        "drop_number_text without value_cache converted dropped text at run-time");
+    expect(!dropped.trycontains("Unused", "blob"), "drop_number_text kept a dropped section");
+
+    // The value cache converts dropped numbers for run-time lookups
+    expect(dropped_cached.tryget<int>("Net", "port") == 8080 && dropped_cached.tryget<int>("Net", "retries") == 16 &&
+        dropped_cached.tryget<double>("Net", "scale") == 2500.0 && dropped_cached.tryget<int>("Log", "level") == 3,
+        "value_cache did not convert dropped numbers");
+    expect(dropped_cached.tryget_view("Net", "port").empty() && dropped_cached.trycontains<int>("Net", "port"),
+        "value_cache changed what drop_number_text keeps");
+    expect(dropped_cached[dropped_cached.handle<"Net", "port", int>()] == 8080,
+        "A typed handle of a dropped number gives the wrong value");
+
+    std::printf("%s\n", failures == 0 ? "sections: filtered configs agree with the full config" :
+        "sections: FAILED");
+    return failures != 0;
+}
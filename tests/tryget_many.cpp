@@ -0,0 +1,172 @@
+/**
+ * tryget_many.cpp - Looks up random batches of keys through tryget_many()
+ * on every config type and index policy, and checks each value against
+ * tryget() of the same key: in a section and globally, with keys that are
+ * missing, repeated, or only in another section. A batch given too few
+ * values must throw std::length_error.
+ *
+ * Build and run with e.g.:
+ *   g++ -std=c++20 -O1 -g -fsanitize=address,undefined -I.. tryget_many.cpp -o tryget_many && ./tryget_many [batches [seed]]
+ * Returns 1 if any batch differs.
+ */
+
+#include "ini_config_runtime.hpp"
+
+#include <cstdint> // std::uint64_t
+#include <cstdio> // std::fprintf, std::printf
+#include <cstdlib> // std::strtoull
+#include <filesystem> // std::filesystem::temp_directory_path
+#include <fstream> // std::ofstream
+#include <iterator> // std::size
+#include <span> // std::span
+#include <stdexcept> // std::length_error
+#include <string> // std::string
+#include <string_view> // std::string_view
+#include <type_traits> // std::is_pointer_v, std::remove_cvref_t
+#include <vector> // std::vector
+
+namespace {
+
+constexpr auto text = ini_config::string_container(R"(
+shared = global
+only_global = 1
+[alpha]
+shared = a
+a0 = 10
+a1 = 11
+a2 = twelve
+[beta]
+shared = b
+b0 = 20
+a0 = beta's a0
+[alpha]
+a3 = in a second run, so only found globally
+[gamma]
+g0 = 30
+)");
+
+struct rng {
+    std::uint64_t state;
+
+    std::uint64_t next() noexcept {
+        auto z = (state += 0x9E3779B97F4A7C15ull);
+        z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+        z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+        return z ^ (z >> 31);
+    }
+    unsigned int below(unsigned int n) noexcept {
+        return static_cast<unsigned int>(next() % n);
+    }
+};
+
+constexpr const char *keys[] = {
+    "shared", "only_global", "a0", "a1", "a2", "a3", "b0", "g0", "missing", "", "a", "shared0"
+};
+constexpr const char *sections[] = { "alpha", "beta", "gamma", "missing" };
+
+// Values of tryget_many(), which are null-terminated strings or views
+std::string_view text_of(const char *value) {
+    return value != nullptr ? std::string_view(value) : std::string_view();
+}
+std::string_view text_of(std::string_view value) {
+    return value;
+}
+template<typename Value>
+bool is_missing(Value value) {
+    if constexpr (std::is_pointer_v<Value>)
+        return value == nullptr;
+    else
+        return value.data() == nullptr;
+}
+
+// Checks one random batch, in a random section or globally
+template<typename Config>
+bool check_batch(const char *engine, const Config& config, rng& r) {
+    using value_type = std::remove_cvref_t<decltype(config.tryget(""))>;
+    std::vector<value_type> batch(r.below(40));
+    for (auto& key : batch)
+        key = keys[r.below(std::size(keys))];
+    std::vector<value_type> values(batch.size());
+
+    const bool global = r.below(3) == 0;
+    const std::string_view sec = sections[r.below(std::size(sections))];
+    const auto found = global ? config.tryget_many(batch, values) : config.tryget_many(sec, batch, values);
+
+    std::size_t expected_found = 0;
+    for (std::size_t i = 0; i < batch.size(); ++i) {
+        const bool exists = global ? config.trycontains(batch[i]) : config.trycontains(sec, batch[i]);
+        const auto expected = text_of(global ? config.tryget(batch[i]) : config.tryget(sec, batch[i]));
+        expected_found += exists;
+        if (is_missing(values[i]) == exists || text_of(values[i]) != expected) {
+            std::fprintf(stderr, "%s: tryget_many(%s, %s) gave \"%.*s\", expected \"%.*s\"\n", engine,
+                global ? "(global)" : sec.data(), std::string(text_of(batch[i])).c_str(),
+                static_cast<int>(text_of(values[i]).size()), text_of(values[i]).data(),
+                static_cast<int>(expected.size()), expected.data());
+            return false;
+        }
+    }
+    if (found != expected_found) {
+        std::fprintf(stderr, "%s: tryget_many() found %zu keys, expected %zu\n", engine, found, expected_found);
+        return false;
+    }
+    return true;
+}
+
+// Checks that a batch with too few values throws, writing none of them
+template<typename Config>
+bool check_short(const char *engine, const Config& config) {
+    using value_type = std::remove_cvref_t<decltype(config.tryget(""))>;
+    value_type batch[2] = { "a0", "a1" };
+    value_type values[1] = {};
+    try {
+        config.tryget_many("alpha", batch, values);
+    } catch (const std::length_error&) {
+        return is_missing(values[0]);
+    }
+    std::fprintf(stderr, "%s: a short batch did not throw\n", engine);
+    return false;
+}
+
+template<typename Config>
+unsigned long long check(const char *engine, const Config& config, unsigned long long batches, rng& r) {
+    unsigned long long failures = !check_short(engine, config);
+    for (unsigned long long n = 0; n < batches; ++n)
+        failures += !check_batch(engine, config, r);
+    return failures;
+}
+
+} // namespace
+
+int main(int argc, char **argv) {
+    const auto batches = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 2000;
+    rng r{ argc > 2 ? std::strtoull(argv[2], nullptr, 10) : 1 };
+    const std::string_view input(text.data, text.size() - 1);
+
+    unsigned long long failures = 0;
+    failures += check("ini_config", make_ini_config<text>, batches, r);
+    failures += check("ini_config<sorted>", make_ini_config<text, ini_config::sorted_index>, batches, r);
+    failures += check("ini_config<linear>", make_ini_config<text, ini_config::linear_index>, batches, r);
+    failures += check("ini_config<lookup_stats>", make_ini_config<text, ini_config::lookup_stats>, batches, r);
+
+    const ini_config::runtime_config runtime(input);
+    failures += check("runtime_config", runtime, batches, r);
+    failures += check("runtime_config<sorted>",
+        ini_config::basic_runtime_config<char, ini_config::sorted_index>(input), batches, r);
+    failures += check("runtime_config<linear>",
+        ini_config::basic_runtime_config<char, ini_config::linear_index>(input), batches, r);
+
+    const auto blob = runtime.blob();
+    failures += check("blob_config", ini_config::blob_config(std::span<const unsigned char>(blob)), batches, r);
+    failures += check("layered_config",
+        ini_config::layered_config(make_ini_config<text>, ini_config::runtime_config()), batches, r);
+
+#ifdef TCSULLIVAN_INI_CONFIG_HAS_MMAP
+    const auto path = (std::filesystem::temp_directory_path() / "ini_config_tryget_many.ini").string();
+    std::ofstream(path, std::ios::binary) << input;
+    failures += check("mapped_config", ini_config::mapped_config::from_file(path.c_str()), batches, r);
+    std::filesystem::remove(path);
+#endif
+
+    std::printf("%s\n", failures == 0 ? "tryget_many: every batch agrees with tryget()" : "tryget_many: FAILED");
+    return failures != 0;
+}
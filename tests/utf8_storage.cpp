@@ -0,0 +1,129 @@
+/**
+ * utf8_storage.cpp - Checks configs of wchar_t, char16_t, and char32_t text
+ * stored as UTF-8 against the same text stored in its own char type: the
+ * same kvps in the same order, once transcoded, and the same lookups,
+ * whether given UTF-8 strings or strings of the original char type, as
+ * strings or as numbers. Both must also match a char config parsed from
+ * the UTF-8 text directly. The text holds 2-, 3-, and 4-byte sequences,
+ * the last being surrogate pairs in UTF-16.
+ *
+ * Build and run with e.g.:
+ *   g++ -std=c++20 -O1 -g -fsanitize=address,undefined -I.. utf8_storage.cpp -o utf8_storage && ./utf8_storage
+ * Returns 1 if any check fails.
+ */
+
+#include "ini_config.hpp"
+
+#include <concepts> // std::same_as
+#include <cstdio> // std::fprintf, std::printf
+#include <string> // std::basic_string, std::string
+#include <string_view> // std::basic_string_view, std::string_view
+
+namespace {
+
+// The same text in each char type
+#define UTF8_STORAGE_TEXT(prefix) prefix ## "greeting = hello\n" \
+    "[caf\u00E9]\nname = cr\u00E8me br\u00FBl\u00E9e\nprice = 4.5\ncount = 12\n" \
+    "[\u6771\u4EAC]\n\u99C5 = \u65B0\u5BBF\ncount = -3\n" \
+    "[emoji]\nface = \U0001F600 and \U0001F680\n\U0001F511 = 0x20\n" \
+    "[caf\u00E9]\ncount = 99\n"
+
+constexpr auto narrow = ini_config::string_container(UTF8_STORAGE_TEXT());
+constexpr auto wide = ini_config::string_container(UTF8_STORAGE_TEXT(L));
+constexpr auto utf16 = ini_config::string_container(UTF8_STORAGE_TEXT(u));
+constexpr auto utf32 = ini_config::string_container(UTF8_STORAGE_TEXT(U));
+
+int failures = 0;
+
+std::string_view text_of(const char *s) {
+    return s != nullptr ? std::string_view(s) : std::string_view();
+}
+
+// Checks a config stored as UTF-8 against the same text in its own chars
+template<typename input_char, typename Stored, typename Native, typename Reference>
+void check(const char *name, const Stored& stored, const Native& native, const Reference& reference) {
+    using input_view = std::basic_string_view<input_char>;
+    static_assert(std::same_as<decltype(stored.tryget("")), const char *>);
+    static_assert(sizeof(stored) < sizeof(native), "UTF-8 storage is not smaller");
+
+    if (stored.end() - stored.begin() != native.end() - native.begin() ||
+        stored.end() - stored.begin() != reference.end() - reference.begin())
+    {
+        std::fprintf(stderr, "%s: has the wrong number of kvps\n", name);
+        ++failures;
+        return;
+    }
+    auto i = stored.begin();
+    auto r = reference.begin();
+    for (auto j = native.begin(); j != native.end(); ++i, ++j, ++r) {
+        const auto& kvp = *j;
+        const auto sec = kvp.section != nullptr ? ini_config::transcode<char>(kvp.section) : std::string();
+        const auto key = ini_config::transcode<char>(kvp.first);
+        const auto value = ini_config::transcode<char>(kvp.second);
+
+        // Iteration gives the text transcoded, as the char config has it
+        if (text_of((*i).section) != sec || text_of((*i).first) != key || text_of((*i).second) != value ||
+            text_of((*r).first) != key || text_of((*r).second) != value)
+        {
+            std::fprintf(stderr, "%s: kvp %s/%s differs\n", name, sec.c_str(), key.c_str());
+            ++failures;
+            continue;
+        }
+
+        // Lookups given UTF-8 or the original chars find what the config
+        // in its own chars finds
+        const auto expected = ini_config::transcode<char>(input_view(native.tryget(kvp.first)));
+        bool ok = stored.tryget_view(key) == expected &&
+            stored.tryget(input_view(kvp.first)) == input_view(native.tryget(kvp.first)) &&
+            stored.trycontains(input_view(kvp.first)) && stored.trycontains(key) &&
+            stored.template tryget<double>(input_view(kvp.first)) == native.template tryget<double>(kvp.first) &&
+            stored.template tryget<long>(key) == native.template tryget<long>(kvp.first);
+        if (kvp.section != nullptr) {
+            const auto expected_in = input_view(native.tryget(kvp.section, kvp.first));
+            ok = ok && stored.tryget_view(sec, key) == ini_config::transcode<char>(expected_in) &&
+                stored.tryget(input_view(kvp.section), input_view(kvp.first)) == expected_in &&
+                stored.trycontains(input_view(kvp.section), input_view(kvp.first)) &&
+                stored.template tryget<int>(input_view(kvp.section), input_view(kvp.first)) ==
+                    native.template tryget<int>(kvp.section, kvp.first) &&
+                text_of(reference.tryget(sec.c_str(), key.c_str())) == stored.tryget_view(sec, key);
+        }
+        if (!ok) {
+            std::fprintf(stderr, "%s: lookups of %s/%s differ\n", name, sec.c_str(), key.c_str());
+            ++failures;
+        }
+    }
+
+    // Missing keys give empty strings of either char type
+    const input_char missing[] = { 'm', 'i', 's', 's', 'i', 'n', 'g', 0 };
+    if (stored.trycontains(input_view(missing)) || !stored.tryget(input_view(missing)).empty() ||
+        stored.tryget(input_view(missing), input_view(missing)) != std::basic_string<input_char>() ||
+        !stored.tryget_view("missing").empty() || stored.template tryget<int>(input_view(missing)) != 0)
+    {
+        std::fprintf(stderr, "%s: found a missing key\n", name);
+        ++failures;
+    }
+}
+
+} // namespace
+
+int main() {
+    constexpr auto reference = make_ini_config<narrow>;
+    check<wchar_t>("wchar_t", make_ini_config<wide, ini_config::utf8_storage>, make_ini_config<wide>, reference);
+    check<char16_t>("char16_t", make_ini_config<utf16, ini_config::utf8_storage>, make_ini_config<utf16>, reference);
+    check<char32_t>("char32_t", make_ini_config<utf32, ini_config::utf8_storage, ini_config::sorted_index>,
+        make_ini_config<utf32>, reference);
+
+    // Lookups by keys of 4-byte sequences, given as surrogate pairs
+    constexpr auto stored16 = make_ini_config<utf16, ini_config::utf8_storage>;
+    if (stored16.tryget(std::u16string_view(u"emoji"), std::u16string_view(u"\U0001F511")) != u"0x20" ||
+        stored16.tryget<int>(std::u16string_view(u"emoji"), std::u16string_view(u"\U0001F511")) != 32 ||
+        stored16.tryget_view("emoji", "face") != "\xF0\x9F\x98\x80 and \xF0\x9F\x9A\x80")
+    {
+        std::fprintf(stderr, "char16_t: surrogate pairs were not transcoded\n");
+        ++failures;
+    }
+
+    std::printf("%s\n", failures == 0 ? "utf8_storage: every config agrees with its own char type" :
+        "utf8_storage: FAILED");
+    return failures != 0;
+}